@@ -0,0 +1,114 @@
+// QCodeEditor
+#include <QCodeEditor>
+#include <QFuzzyMatcher>
+
+// Qt
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <cstdio>
+
+static QString generateDocument(int lines)
+{
+    QString text;
+    for (int i = 0; i < lines; ++i)
+    {
+        text += QString("    int value%1 = compute(%1, \"line\"); // comment\n").arg(i);
+    }
+
+    return text;
+}
+
+static void benchmarkSwapLines(int lines, int iterations)
+{
+    QCodeEditor editor;
+    editor.setPlainText(generateDocument(lines));
+
+    // Lines are moved in the middle of the document, where a whole document rewrite would cost the most
+    auto cursor = editor.textCursor();
+    cursor.setPosition(editor.document()->findBlockByNumber(lines / 2).position());
+    editor.setTextCursor(cursor);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        editor.swapLineUp();
+        editor.swapLineDown();
+    }
+
+    auto elapsed = timer.nsecsElapsed();
+    std::printf("swapLineUp/swapLineDown %8d lines: %10.3f us per move\n", lines,
+                elapsed / 1000.0 / (2.0 * iterations));
+}
+
+static void benchmarkFuzzyMatch(int candidates, int iterations)
+{
+    static const char *const WORDS[] = {"vec", "normalize", "texture", "sample", "matrix", "light", "color", "index"};
+
+    // Identifiers of two or three words, in camelCase and with underscores
+    QStringList list;
+    for (int i = 0; i < candidates; ++i)
+    {
+        QString candidate = WORDS[i % 8];
+        QString second = WORDS[(i / 8) % 8];
+        if (i % 2 == 0)
+        {
+            candidate += second.at(0).toUpper() + second.mid(1);
+        }
+        else
+        {
+            candidate += "_" + second;
+        }
+
+        if (i % 3 == 0)
+        {
+            candidate += QString("_") + WORDS[(i / 64) % 8];
+        }
+
+        list.append(candidate + QString::number(i));
+    }
+
+    QFuzzyMatcher matcher(list);
+
+    for (auto pattern : {"v", "vec4n", "nrm", "texSmp", "lc"})
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            matcher.match(pattern, 50);
+        }
+
+        auto elapsed = timer.nsecsElapsed();
+        std::printf("QFuzzyMatcher::match %8d candidates, %-6s: %10.3f us per match\n", candidates, pattern,
+                    elapsed / 1000.0 / iterations);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // The editor is never shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication a(argc, argv);
+
+    // The cost of moving a line doesn't depend on the size of the document
+    for (auto lines : {1000, 10000, 100000})
+    {
+        benchmarkSwapLines(lines, 200);
+    }
+
+    // Matching 100k candidates has to stay below a millisecond
+    benchmarkFuzzyMatch(100000, 100);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+// Qt
+#include <QChar>
+#include <QObject> // Required for inheritance
+#include <QTextBlock>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief Class, that summarizes the brackets of consecutive
+ * blocks, so searches over the bracket nesting skip whole
+ * chunks of the document. Summaries are taken from the block
+ * data of the highlighter and are computed again lazily, once
+ * the highlighter invalidated one of their blocks, so a changed
+ * nesting doesn't cascade over the blocks after it. One index
+ * belongs to a document and is its child.
+ */
+class QBracketIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Document, whose brackets are indexed.
+     */
+    explicit QBracketIndex(QTextDocument *document);
+
+    // Disable copying
+    QBracketIndex(const QBracketIndex &) = delete;
+    QBracketIndex &operator=(const QBracketIndex &) = delete;
+
+    /**
+     * @brief Static method for getting the index of a document.
+     * @return Pointer to index. May be nullptr if the document
+     * wasn't highlighted yet.
+     */
+    static QBracketIndex *get(const QTextDocument *document);
+
+    /**
+     * @brief Method for marking the brackets of a block as changed.
+     */
+    void invalidate(const QTextBlock &block);
+
+    /**
+     * @brief Method for getting the nesting depth of all bracket
+     * pairs at the start of a block. It's summed up from the
+     * chunks before the block and the blocks before it in its chunk.
+     */
+    int depth(const QTextBlock &block);
+
+    /**
+     * @brief Method for skipping the blocks from a block on,
+     * in which the nesting of a bracket pair can't drop to zero.
+     * @param block First block to look at.
+     * @param open Opening bracket. Null with close for all pairs.
+     * @param close Closing bracket.
+     * @param depth Nesting at the start of block, is updated to
+     * the nesting at the start of the returned block.
+     * @return First block, that has to be looked at bracket by
+     * bracket. Invalid, if there is none.
+     */
+    QTextBlock findForward(QTextBlock block, QChar open, QChar close, int &depth);
+
+    /**
+     * @brief Method for skipping the blocks from a block back,
+     * in which the nesting of a bracket pair, taken backwards,
+     * can't drop to zero.
+     * @param block Last block to look at.
+     * @param open Opening bracket. Null with close for all pairs.
+     * @param close Closing bracket.
+     * @param depth Nesting at the end of block, counted by the
+     * closing brackets, is updated to the nesting at the end of
+     * the returned block.
+     * @return Last block, that has to be looked at bracket by
+     * bracket. Invalid, if there is none.
+     */
+    QTextBlock findBackward(QTextBlock block, QChar open, QChar close, int &depth);
+
+  private slots:
+    /**
+     * @brief Slot, that keeps the chunks in line with the
+     * blocks, that were inserted or removed.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Struct, that describes how the brackets of a pair,
+     * or of all pairs, nest over a range of blocks.
+     */
+    struct Summary
+    {
+        QChar open;
+        QChar close;
+
+        /**
+         * @brief Change of the nesting by the range.
+         */
+        int delta;
+
+        /**
+         * @brief Lowest nesting in the range relative to its start.
+         * For all pairs, it's a bound, that mixed pairs may not reach.
+         */
+        int minimum;
+
+        /**
+         * @brief Did every block of the range record the pair.
+         */
+        bool complete;
+    };
+
+    /**
+     * @brief Struct, that describes consecutive blocks.
+     */
+    struct Chunk
+    {
+        int first;
+        int count;
+        bool valid;
+        Summary all;
+        QVector<Summary> pairs;
+    };
+
+    /**
+     * @brief Static method for getting the summary of a block.
+     * @return False if the block didn't record the pair.
+     */
+    static bool blockSummary(const QTextBlock &block, QChar open, QChar close, int &delta, int &minimum);
+
+    /**
+     * @brief Method for getting the summary of a chunk.
+     * @return Pointer to summary. May be nullptr if a block of
+     * the chunk didn't record the pair.
+     */
+    const Summary *chunkSummary(int chunk, QChar open, QChar close);
+
+    /**
+     * @brief Method for summarizing a chunk again, if it
+     * was invalidated.
+     */
+    void validate(int chunk);
+
+    /**
+     * @brief Method for summarizing the blocks of a chunk.
+     */
+    void summarize(Chunk &chunk) const;
+
+    /**
+     * @brief Method for finding the chunk of a block by binary search.
+     * @return Index of the chunk.
+     */
+    int chunkAt(int number) const;
+
+    /**
+     * @brief Method for invalidating the chunk of a block.
+     */
+    void markChanged(int number);
+
+    /**
+     * @brief Method for updating the first block of the chunks
+     * from a chunk on.
+     */
+    void renumber(int chunk);
+
+    /**
+     * @brief Method for splitting the document into chunks
+     * again, that are all invalid.
+     */
+    void reset();
+
+    /**
+     * @brief Method for resetting the chunks, if an edit of the
+     * document wasn't seen yet.
+     */
+    void synchronize();
+
+    QTextDocument *m_document;
+    QVector<Chunk> m_chunks;
+    int m_blockCount;
+
+    // Blocks, that were invalidated while the chunks were behind an edit
+    QVector<int> m_pending;
+};
@@ -1,21 +1,57 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
+class QTextDocument;
 
-class QSyntaxStyle;
-class QString;
+/**
+ * @brief Compile time rule tables of the C++ highlighter.
+ */
+struct QCXXLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/cpp.xml";
+    static constexpr const char *keywordPattern = R"(\b%1\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {
+        // Include
+        {R"(^\s*#\s*include\s*([<"][^:?"<>\|]+[">]))", "Preprocessor", 1, "String"},
+        // Function
+        {R"(\b([_a-zA-Z][_a-zA-Z0-9]*\s+)?((?:[_a-zA-Z][_a-zA-Z0-9]*\s*::\s*)*[_a-zA-Z][_a-zA-Z0-9]*)(?=\s*\())", "Type", 2, "Function"},
+        // Type of definition
+        {R"(\b([_a-zA-Z][_a-zA-Z0-9]*)\s+[_a-zA-Z][_a-zA-Z0-9]*\s*[;=])", nullptr, 1, "Type"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"((?<=\b|\s|^)(?i)(?:(?:(?:(?:(?:\d+(?:'\d+)*)?\.(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)\.(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)?\.(?:[0-9a-f]+(?:'[0-9a-f]+)*)(?:p[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)\.?(?:p[+-]?(?:\d+(?:'\d+)*))))[lf]?)|(?:(?:(?:[1-9]\d*(?:'\d+)*)|(?:0[0-7]*(?:'[0-7]+)*)|(?:0x[0-9a-f]+(?:'[0-9a-f]+)*)|(?:0b[01]+(?:'[01]+)*))(?:u?l{0,2}|l{0,2}u?)))(?=\b|\s|$))", "Number"},
+        // Strings
+        {R"("[^\n"]*")", "String"},
+        // Define
+        {R"(#[a-zA-Z_]+)", "Preprocessor"},
+        // Single line
+        {R"(//[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline comments
+        {R"(/\*)", R"(\*/)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "//";
+    static constexpr const char *commentBlockStart = "/*";
+    static constexpr const char *commentBlockEnd = "*/";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
 
 /**
  * @brief Class, that describes C++ code
  * highlighter.
  */
-class QCXXHighlighter : public QStyleSyntaxHighlighter
+class QCXXHighlighter : public QRuleHighlighter<QCXXLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -24,17 +60,4 @@ class QCXXHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QCXXHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-
-    QRegularExpression m_includePattern;
-    QRegularExpression m_functionPattern;
-    QRegularExpression m_defTypePattern;
-
-    QRegularExpression m_commentStartPattern;
-    QRegularExpression m_commentEndPattern;
 };
@@ -0,0 +1,109 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QHighlightToken.hpp>
+
+// Qt
+#include <QTextBlock>
+#include <QTextBlockUserData> // Required for inheritance
+#include <QVector>
+
+/**
+ * @brief Class, that describes data attached to a
+ * text block by the highlighter.
+ */
+class QCodeBlockData : public QTextBlockUserData
+{
+  public:
+    /**
+     * @brief Static method for getting data of a block.
+     * @param block Text block.
+     * @return Pointer to data. May be nullptr if the block wasn't
+     * highlighted yet or carries user data of another type.
+     */
+    static QCodeBlockData *get(const QTextBlock &block)
+    {
+        return dynamic_cast<QCodeBlockData *>(block.userData());
+    }
+
+    /**
+     * @brief Struct, that describes a bracket outside of
+     * strings and comments.
+     */
+    struct Bracket
+    {
+        int position;
+        QChar character;
+    };
+
+    /**
+     * @brief Struct, that describes the brackets of one pair
+     * in the block, so matching can skip the whole block.
+     */
+    struct BracketSummary
+    {
+        QChar open;
+        QChar close;
+
+        /**
+         * @brief Opening brackets, that aren't closed in the block.
+         */
+        int unmatchedOpens;
+
+        /**
+         * @brief Closing brackets, that aren't opened in the block.
+         */
+        int unmatchedCloses;
+
+        friend bool operator==(const BracketSummary &lhs, const BracketSummary &rhs)
+        {
+            return lhs.open == rhs.open && lhs.close == rhs.close && lhs.unmatchedOpens == rhs.unmatchedOpens &&
+                   lhs.unmatchedCloses == rhs.unmatchedCloses;
+        }
+
+        friend bool operator!=(const BracketSummary &lhs, const BracketSummary &rhs)
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    /**
+     * @brief Method for getting the summary of a bracket pair.
+     * @return Pointer to summary. May be nullptr if the pair
+     * wasn't recorded by the highlighter.
+     */
+    const BracketSummary *bracketSummary(QChar open, QChar close) const
+    {
+        for (auto &&summary : bracketSummaries)
+        {
+            if (summary.open == open && summary.close == close)
+            {
+                return &summary;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Non overlapping tokens of the block, sorted by start.
+     */
+    QVector<QHighlightToken> tokens;
+
+    /**
+     * @brief Brackets of all pairs, sorted by position.
+     */
+    QVector<Bracket> brackets;
+
+    /**
+     * @brief Summaries of the bracket pairs of the highlighter.
+     */
+    QVector<BracketSummary> bracketSummaries;
+
+    /**
+     * @brief Change of the nesting depth of all bracket pairs
+     * by the block. The depth at its start is resolved from the
+     * deltas, see QBracketIndex::depth.
+     */
+    int bracketDelta = 0;
+};
@@ -2,9 +2,17 @@
 
 #include <interval-tree/interval_tree.hpp>
 
+#include <functional>
+
+// QCodeEditor
+#include <internal/QHighlightToken.hpp>
+#include <internal/QStyleSyntaxHighlighter.hpp>
+
 // Qt
 #include <QList>
+#include <QMap>
 #include <QRegularExpression>
+#include <QSharedPointer>
 #include <QString>
 #include <QTextEdit> // Required for inheritance
 #include <QVector>
@@ -18,11 +26,24 @@ class QEvent;
 class QResizeEvent;
 class QPaintEvent;
 class QMimeData;
+class QMouseEvent;
+class QPainter;
+class QBrush;
 class QFont;
+class QAbstractItemModel;
 class QCompleter;
+class QCompletionEngine;
+class QCompletionProvider;
+class QStringListModel;
 class QLineNumberArea;
 class QSyntaxStyle;
-class QStyleSyntaxHighlighter;
+class QIdentifierIndex;
+class QIndentationEngine;
+class QSearchEngine;
+class QSnippet;
+class QSnippetSession;
+class QTaskScheduler;
+class QUndoHistory;
 
 /**
  * @brief Class, that describes code editor.
@@ -75,6 +96,31 @@ class QCodeEditor : public QTextEdit
         QString code;
     };
 
+    /**
+     * @brief Struct, that describes a decorated range
+     * of a decoration layer.
+     */
+    struct Decoration
+    {
+        /**
+         * @brief Start position. Inclusive.
+         */
+        int start;
+
+        /**
+         * @brief End position. Exclusive.
+         */
+        int end;
+
+        /**
+         * @brief Format. The background, the underline and the
+         * FullWidthSelection property are painted. Full width
+         * decorations cover the lines of the range, even if
+         * it's empty.
+         */
+        QTextCharFormat format;
+    };
+
     struct Parenthesis
     {
         QChar left, right;
@@ -143,6 +189,9 @@ class QCodeEditor : public QTextEdit
 
     /**
      * @brief Method for setting auto indentation enabled.
+     * New lines, pasted lines and lines, that get a closing
+     * bracket typed, are indented by the indentation engine
+     * of the highlighter.
      */
     void setAutoIndentation(bool enabled);
 
@@ -162,6 +211,34 @@ class QCodeEditor : public QTextEdit
      */
     bool autoIndentation() const;
 
+    /**
+     * @brief Method for setting bracket pair colorization enabled.
+     * Brackets of the visible lines are colored by their nesting
+     * depth, with the Bracket.Level1 to Bracket.Level3 formats of
+     * the syntax style.
+     */
+    void setBracketPairColorization(bool enabled);
+
+    /**
+     * @brief Method for getting is bracket pair colorization enabled.
+     * Default: true
+     */
+    bool bracketPairColorization() const;
+
+    /**
+     * @brief Method for setting document word completion enabled.
+     * Identifiers of the document are then merged into the provided
+     * completions, ranked by how often and how near to the cursor
+     * they occur. Only used together with a completion provider.
+     */
+    void setDocumentWordCompletion(bool enabled);
+
+    /**
+     * @brief Method for getting is document word completion enabled.
+     * Default: true
+     */
+    bool documentWordCompletion() const;
+
     /**
      * @brief Method for setting completer.
      * @param completer Pointer to completer object.
@@ -174,6 +251,84 @@ class QCodeEditor : public QTextEdit
      */
     QCompleter *completer() const;
 
+    /**
+     * @brief Method for setting the completion provider. Completions
+     * are then requested on the thread pool while typing, requests of
+     * earlier keystrokes are cancelled, and the popup shows the
+     * completions as they arrive.
+     * @param provider Pointer to provider. nullptr falls back to the
+     * provider of the completer, if it's a QLanguageCompleter.
+     */
+    void setCompletionProvider(const QSharedPointer<QCompletionProvider> &provider);
+
+    /**
+     * @brief Method for getting the completion provider.
+     * @return Pointer to provider, that's used. May be nullptr, then
+     * the completer filters its own model.
+     */
+    QSharedPointer<QCompletionProvider> completionProvider() const;
+
+    /**
+     * @brief Method for expanding a snippet in place of the
+     * selection, as one edit. Lines after the first one get the
+     * indentation of the line. Tab and Shift+Tab then move between
+     * the tab stops, Escape or moving the cursor out of the snippet
+     * ends it.
+     * @param snippet Snippet.
+     */
+    void insertSnippet(const QSnippet &snippet);
+
+    /**
+     * @brief Method for getting is a snippet being filled in.
+     */
+    bool isSnippetActive() const;
+
+    /**
+     * @brief Method for setting is the undo history used in
+     * place of the undo stack of the document. It keeps only the
+     * replaced text, undoes typing word by word and stays within
+     * a memory limit. Either way, the steps so far are removed.
+     * @details While it's used, the undo stack of the document is
+     * disabled. Undo and redo work by the keyboard, the context
+     * menu, undoStep() and redoStep(). QTextEdit::undo() and
+     * QTextDocument::undo() do nothing then. Replacing the text,
+     * e.g. by setPlainText(), is an undo step, clearUndoHistory()
+     * removes it. Default is false.
+     * @param enabled Use the undo history.
+     */
+    void setUndoHistoryEnabled(bool enabled);
+
+    /**
+     * @brief Method for getting is the undo history used.
+     */
+    bool isUndoHistoryEnabled() const;
+
+    /**
+     * @brief Method for setting the memory, that the undo
+     * history may take. Older steps are compressed, the oldest
+     * ones are dropped beyond the limit.
+     * @param bytes Limit in bytes. Default is 32 MiB.
+     */
+    void setUndoMemoryLimit(qint64 bytes);
+
+    /**
+     * @brief Method for getting the undo memory limit.
+     */
+    qint64 undoMemoryLimit() const;
+
+    /**
+     * @brief Method for getting the approximate memory, that
+     * the undo history takes, the steps and its copy of the text.
+     * @return Bytes.
+     */
+    qint64 undoMemoryUsage() const;
+
+    /**
+     * @brief Method for removing all undo and redo steps, of
+     * the undo history or the document.
+     */
+    void clearUndoHistory();
+
     /**
      * @brief addDiagnostic add a diagnostic to the editor.
      *        The diagnostics will be shown as underlines in the editor.
@@ -186,6 +341,168 @@ class QCodeEditor : public QTextEdit
 
     void clearDiagnostics();
 
+    /**
+     * @brief Method for setting semantic tokens, that are
+     * merged on top of the highlighter formats.
+     * @param legend Syntax style format names, indexed by token type.
+     * @param data Delta encoded tokens, like LSP semanticTokens/full.
+     * @details Does nothing without a highlighter.
+     */
+    void setSemanticTokens(const QStringList &legend, const QVector<quint32> &data);
+
+    /**
+     * @brief Method for updating semantic tokens with edits,
+     * like LSP semanticTokens/full/delta. Only the blocks whose
+     * tokens changed are rehighlighted.
+     * @param edits Edits of the integer array set before.
+     */
+    void applySemanticTokensEdits(const QVector<QStyleSyntaxHighlighter::SemanticTokensEdit> &edits);
+
+    /**
+     * @brief Method for getting the tokens the highlighter
+     * produced for a block, without lexing it again.
+     * @param block Text block.
+     * @return Non overlapping tokens sorted by start, with
+     * positions relative to the block. Empty if the block
+     * wasn't highlighted.
+     */
+    QVector<QHighlightToken> blockTokens(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting the format name of the token
+     * at a document position, e.g. to skip comments and strings.
+     * @param position Position in the document.
+     * @return Format name, empty if there's no token.
+     */
+    QString tokenFormatAt(int position) const;
+
+    /**
+     * @brief Method for finding the parenthesis, that matches the
+     * one at a position. Brackets in strings and comments are skipped
+     * and blocks without a match are skipped by the bracket index,
+     * chunk by chunk, once they're highlighted.
+     * @param position Position of an opening or closing parenthesis.
+     * @return Position of the matching parenthesis, -1 if there's none.
+     */
+    int matchingParenthesis(int position) const;
+
+    /**
+     * @brief Method for getting the carets besides the
+     * text cursor.
+     * @return Cursors sorted by position, they never overlap
+     * each other or the text cursor.
+     */
+    QVector<QTextCursor> extraCursors() const;
+
+    /**
+     * @brief Method for adding a caret. Typing, deletion,
+     * paste and indentation apply to all carets in a single
+     * edit block.
+     * @param cursor Cursor, may have a selection. It's dropped
+     * if it overlaps an existing caret.
+     */
+    void addCursor(const QTextCursor &cursor);
+
+    /**
+     * @brief Method for removing all carets besides the
+     * text cursor.
+     */
+    void clearExtraCursors();
+
+    /**
+     * @brief Method for setting a rectangular selection. Columns
+     * are visual, a tab advances to the next multiple of
+     * tabReplaceSize. Each line of the rectangle gets a caret, so
+     * typing, paste and deletion apply to all lines at once.
+     * @param anchorLine Block number, where the selection starts.
+     * @param anchorColumn Visual column, where the selection starts.
+     * @param line Block number of the text cursor.
+     * @param column Visual column of the text cursor.
+     */
+    void setBlockSelection(int anchorLine, int anchorColumn, int line, int column);
+
+    /**
+     * @brief Method for getting is there a rectangular selection.
+     * It's dropped by the first edit, which leaves the carets.
+     */
+    bool hasBlockSelection() const;
+
+    /**
+     * @brief Method for getting the number of occurrences of
+     * the selected word in the whole document.
+     * @details It's counted in the background, so it may grow
+     * after the selection changed, see wordOccurrenceCountChanged.
+     */
+    int wordOccurrenceCount() const;
+
+    /**
+     * @brief Method for getting the index of all identifiers
+     * in the document. It's kept up to date while editing.
+     */
+    QIdentifierIndex *identifierIndex() const;
+
+    /**
+     * @brief Method for replacing the decorations of a layer.
+     * Layers are painted below the text, only their visible
+     * ranges are. Other layers aren't touched.
+     * @param layer Name of the layer, it's created if needed.
+     * @param decorations Ranges, in any order. They move along
+     * with edits until they're replaced.
+     * @param z Layers are painted from the lowest z up.
+     */
+    void setDecorations(const QString &layer, const QVector<Decoration> &decorations, int z = 0);
+
+    /**
+     * @brief Method for removing a decoration layer.
+     * @param layer Name of the layer.
+     */
+    void clearDecorations(const QString &layer);
+
+    /**
+     * @brief Method for getting the decorations of a layer.
+     * @return Decorations sorted by start.
+     */
+    QVector<Decoration> decorations(const QString &layer) const;
+
+    /**
+     * @brief Method for getting can a line be folded. It's a
+     * quick check for the gutter, folding may still find no
+     * lines to hide.
+     * @param line Block number.
+     */
+    bool isFoldable(int line) const;
+
+    /**
+     * @brief Method for getting is a line folded.
+     * @param line Block number.
+     */
+    bool isFolded(int line) const;
+
+    /**
+     * @brief Method for getting the last line, that the fold
+     * starting at a line hides.
+     * @param line Block number.
+     * @return Block number, -1 if the line isn't folded.
+     */
+    int lastFoldedLine(int line) const;
+
+    /**
+     * @brief Method for folding or unfolding the region, that
+     * starts at a line. Brackets or indentation delimit it,
+     * depending on the folding style of the highlighter. Only
+     * the lines of the region are hidden and laid out again.
+     * @param line Block number.
+     * @param folded Hide the region.
+     */
+    void setFolded(int line, bool folded);
+
+    /**
+     * @brief Method for folding an unfolded line and
+     * unfolding a folded one.
+     * @param line Block number.
+     */
+    void toggleFold(int line);
+
   signals:
     /**
      * @brief Signal, the font is changed by the wheel event.
@@ -202,8 +519,27 @@ class QCodeEditor : public QTextEdit
      */
     void livecodeTrigger();
 
+    /**
+     * @brief Signal, the number of occurrences of the
+     * selected word changed.
+     */
+    void wordOccurrenceCountChanged(int count);
+
   public slots:
 
+    /**
+     * @brief Slot, that reverts the last undo step, of the undo
+     * history, if it's enabled, or else of the document.
+     */
+    void undoStep();
+
+    /**
+     * @brief Slot, that applies the last reverted undo step
+     * again, of the undo history, if it's enabled, or else of
+     * the document.
+     */
+    void redoStep();
+
     /**
      * @brief Slot, that performs insertion of
      * completion info into code.
@@ -211,6 +547,23 @@ class QCodeEditor : public QTextEdit
      */
     void insertCompletion(const QString &s);
 
+    /**
+     * @brief Slot, that selects the next tab stop of the
+     * snippet, or moves to its final position after the last one.
+     */
+    void nextSnippetField();
+
+    /**
+     * @brief Slot, that selects the previous tab stop of
+     * the snippet.
+     */
+    void previousSnippetField();
+
+    /**
+     * @brief Slot, that ends the snippet. Its text stays.
+     */
+    void exitSnippet();
+
     /**
      * @brief Slot, that performs update of
      * internal editor viewport based on line
@@ -226,10 +579,16 @@ class QCodeEditor : public QTextEdit
     void updateLineNumberArea(const QRect &rect);
 
     /**
-     * @brief Slot, that will proceed extra selection
-     * for current cursor position.
+     * @brief Slot, that schedules highlighting of the
+     * current line and the parentheses at the cursor.
+     * The current line is updated before the next paint.
      */
     void updateParenthesisAndCurrentLineHighlights();
+
+    /**
+     * @brief Slot, that schedules highlighting of the
+     * occurrences of the selected word.
+     */
     void updateWordOccurrenceHighlights();
 
     /**
@@ -247,6 +606,12 @@ class QCodeEditor : public QTextEdit
      */
     void unindent();
 
+    /**
+     * @brief Slot, that indents the selected lines, or the
+     * current line, by the indentation engine in a single edit.
+     */
+    void reindent();
+
     /**
      * @brief Slot, that swap the selected lines up.
      */
@@ -278,6 +643,24 @@ class QCodeEditor : public QTextEdit
      */
     void toggleBlockComment();
 
+    /**
+     * @brief Slot, that unfolds all folded regions.
+     */
+    void unfoldAll();
+
+    /**
+     * @brief Slot, that selects the word under cursor or,
+     * if there's a selection, adds a caret at the next
+     * occurrence of the selected text.
+     */
+    void addNextOccurrence();
+
+    /**
+     * @brief Slot, that adds a caret at every occurrence
+     * of the selected text, or of the word under cursor.
+     */
+    void selectAllOccurrences();
+
   protected:
     /**
      * @brief Method, that's called on any text insertion of
@@ -320,6 +703,35 @@ class QCodeEditor : public QTextEdit
      */
     void keyPressEvent(QKeyEvent *e) override;
 
+    /**
+     * @brief Method, that shows the standard context menu, whose
+     * Undo and Redo use the undo history of the editor.
+     */
+    void contextMenuEvent(QContextMenuEvent *e) override;
+
+    /**
+     * @brief Method, that's called on mouse press. Ctrl+Alt+click
+     * adds a caret, any other click removes the extra carets.
+     */
+    void mousePressEvent(QMouseEvent *e) override;
+
+    /**
+     * @brief Method, that's called on mouse move. Extends the
+     * rectangular selection started by Alt+press.
+     */
+    void mouseMoveEvent(QMouseEvent *e) override;
+
+    /**
+     * @brief Method, that's called on mouse release.
+     */
+    void mouseReleaseEvent(QMouseEvent *e) override;
+
+    /**
+     * @brief Method, that copies the selections of all carets,
+     * one per line, if there are extra carets.
+     */
+    QMimeData *createMimeDataFromSelection() const override;
+
     /**
      * @brief Method, that's called on focus into widget.
      * It's required for setting this widget to set
@@ -344,6 +756,20 @@ class QCodeEditor : public QTextEdit
     void updateBottomMargin();
 
   private:
+    /**
+     * @brief Enum, that describes the work, the editor leaves
+     * to its scheduler. Tasks of the same priority run in this
+     * order.
+     */
+    enum Task
+    {
+        CurrentLineTask,
+        LineNumberTask,
+        BottomMarginTask,
+        ParenthesisTask,
+        WordOccurrenceTask
+    };
+
     /**
      * @brief Method for initializing default
      * monospace font.
@@ -370,6 +796,60 @@ class QCodeEditor : public QTextEdit
     bool proceedCompleterBegin(QKeyEvent *e);
     void proceedCompleterEnd(QKeyEvent *e);
 
+    /**
+     * @brief Method for getting the completer, that shows
+     * the popup. With a completion provider it's the one
+     * of the editor, that shows the provided completions.
+     */
+    QCompleter *activeCompleter() const;
+
+    /**
+     * @brief Method for requesting completions from the
+     * completion provider.
+     * @param prefix Word before the cursor.
+     * @param explicitRequest Was it requested by the shortcut.
+     */
+    void requestCompletions(const QString &prefix, bool explicitRequest);
+
+    /**
+     * @brief Method for showing a batch of provided completions.
+     * @param first Does it replace the completions shown before.
+     */
+    void showCompletions(const QStringList &completions, bool first);
+
+    /**
+     * @brief Method for hiding the completion popup and
+     * cancelling the running request.
+     */
+    void hideCompletions();
+
+    /**
+     * @brief Method, that moves between the tab stops of
+     * the snippet by keys.
+     * @return Was the key handled.
+     */
+    bool proceedSnippetKey(QKeyEvent *e);
+
+    /**
+     * @brief Method, that types into the current tab stop of
+     * the snippet and its linked tab stops in one edit.
+     * @return Was the key handled.
+     */
+    bool proceedLinkedFieldKey(QKeyEvent *e);
+
+    /**
+     * @brief Method for selecting the current tab stop of
+     * the snippet and showing its choices.
+     */
+    void selectSnippetField();
+
+    /**
+     * @brief Method for getting the width of the popup of a
+     * completer. Only the first rows are measured, and each
+     * of them once, as long as the model and the prefix stay.
+     */
+    int completionPopupWidth(QCompleter *completer);
+
     /**
      * @brief Method for getting character under
      * cursor.
@@ -385,19 +865,111 @@ class QCodeEditor : public QTextEdit
     QString wordUnderCursor() const;
 
     /**
-     * @brief Method, that adds highlighting of
-     * currently selected line to extra selection list.
+     * @brief Method, that updates the decoration layer
+     * of the current line.
      */
     void highlightCurrentLine();
 
     /**
-     * @brief Method, that adds highlighting of
-     * parenthesis if available.
+     * @brief Method, that updates the decoration layer
+     * of the parentheses at the cursor. Their foreground is
+     * applied as extra selections, that decorations don't paint.
      */
     void highlightParenthesis();
 
+    /**
+     * @brief Method, that starts searching the occurrences of the
+     * selected word, unless they are already indexed.
+     */
     void highlightWordOccurrences();
 
+    /**
+     * @brief Method for getting how regions are found for
+     * folding. Plain text is folded by indentation.
+     */
+    QStyleSyntaxHighlighter::FoldingStyle foldingStyle() const;
+
+    /**
+     * @brief Method for finding the last line of the region,
+     * that starts at a block. The line of a closing bracket
+     * stays visible.
+     * @return Block number, -1 if there's nothing to fold.
+     */
+    int foldEnd(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting the fold, that starts at a block.
+     * @return Index in the folds, -1 if the block isn't folded.
+     */
+    int foldIndex(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for showing or hiding lines. Only their
+     * layout is updated, folded regions inside stay hidden.
+     */
+    void setLinesVisible(int firstLine, int lastLine, bool visible);
+
+    /**
+     * @brief Method for finding, for every fold, the one up to
+     * it, whose region ends last. Has to be called, once the
+     * folds changed.
+     */
+    void indexFolds();
+
+    /**
+     * @brief Method, that checks the folds touched by an edit and
+     * unfolds or resizes the ones, whose region changed.
+     */
+    void updateFolds(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for getting the indentation engine of
+     * the highlighter, or a bracket based one without it.
+     */
+    const QIndentationEngine *indentationEngine() const;
+
+    /**
+     * @brief Method for building the whitespace of an
+     * indentation, with tabs unless tabs are replaced.
+     * @param columns Indentation in columns.
+     */
+    QString indentationString(int columns) const;
+
+    /**
+     * @brief Method for replacing the leading whitespace
+     * of a line. The block data of the line is updated
+     * right away, even inside an edit block.
+     */
+    void setLineIndentation(QTextCursor &cursor, const QTextBlock &block, int columns);
+
+    /**
+     * @brief Method for indenting lines by the indentation
+     * engine. Lines of significant indentation are shifted
+     * together, keeping their relative indentation.
+     * @param joinPreviousEdit Make it one undo step with the
+     * previous edit, e.g. a paste.
+     */
+    void reindentLines(int firstLine, int lastLine, bool joinPreviousEdit);
+
+    /**
+     * @brief Method for inserting a line break and indenting
+     * the new line. Between braces the closing brace gets a
+     * line of its own.
+     */
+    void insertIndentedLineBreak();
+
+    /**
+     * @brief Method for painting the brackets of the visible
+     * blocks over the text, in the colors of their depth.
+     */
+    void paintBracketColors(QPainter &painter);
+
+    /**
+     * @brief Method for painting the occurrences of the selected
+     * word, that are visible in the viewport.
+     */
+    void paintWordOccurrences(QPainter &painter);
+
     /**
      * @brief Method for remove the first group of regex
      * in each line of the selection.
@@ -417,6 +989,175 @@ class QCodeEditor : public QTextEdit
      */
     void addInEachLineOfSelection(const QRegularExpression &regex, const QString &str);
 
+    /**
+     * @brief Method, that performs key processing while there
+     * are extra carets.
+     * @param e Pointer to key event.
+     * @return Was the event handled.
+     */
+    bool proceedMultiCursorKey(QKeyEvent *e);
+
+    /**
+     * @brief Method for applying an edit to the text cursor and
+     * all extra carets inside a single edit block, so the document
+     * is laid out and highlighted once.
+     * @param edit Called for each cursor with its index in
+     * document order. It may change the lines of the cursor's
+     * selection and the line breaks around them.
+     */
+    void editCursors(const std::function<void(QTextCursor &cursor, int index)> &edit);
+
+    /**
+     * @brief Method for moving the text cursor and all extra carets.
+     */
+    void moveCursors(QTextCursor::MoveOperation operation, QTextCursor::MoveMode mode);
+
+    /**
+     * @brief Method for sorting the extra carets and dropping
+     * the ones, that overlap another caret.
+     */
+    void mergeCursors();
+
+    /**
+     * @brief Method for moving the extra carets along with an
+     * edit, that wasn't made through editCursors().
+     */
+    void shiftCursors(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for filling the background of a document
+     * range on the viewport, line by line.
+     */
+    void paintTextRange(QPainter &painter, int start, int end, const QBrush &brush);
+
+    struct DecorationLayer
+    {
+        int z = 0;
+
+        /**
+         * @brief Decorations sorted by start.
+         */
+        QVector<Decoration> decorations;
+
+        /**
+         * @brief Maximum end of the decorations up to each index,
+         * so the first one, that may overlap a range, is found by
+         * binary search.
+         */
+        QVector<int> maximumEnds;
+
+        /**
+         * @brief Shift of the decorations from shiftFrom on, that
+         * isn't applied to them yet. An edit only moves the ones,
+         * that lie between it and the previous edit.
+         */
+        int shiftFrom = 0;
+        int shift = 0;
+    };
+
+    /**
+     * @brief Static method for updating the index of the
+     * decorations of a layer.
+     */
+    static void indexDecorations(DecorationLayer &layer);
+
+    /**
+     * @brief Static method for getting a decoration of a layer
+     * with its pending shift.
+     */
+    static Decoration decorationAt(const DecorationLayer &layer, int index);
+
+    /**
+     * @brief Static method for getting a maximum end of a layer
+     * with its pending shift.
+     */
+    static int maximumEndAt(const DecorationLayer &layer, int index);
+
+    /**
+     * @brief Static method for applying the pending shift to the
+     * decorations before an index, and taking it from the ones
+     * after it, so it's pending from the index on.
+     */
+    static void settleDecorations(DecorationLayer &layer, int index);
+
+    /**
+     * @brief Static method for getting the decorations of a
+     * layer, that overlap a range.
+     * @param from Start position, inclusive.
+     * @param to End position, inclusive.
+     */
+    static QVector<Decoration> decorationsInRange(const DecorationLayer &layer, int from, int to);
+
+    /**
+     * @brief Method for scheduling repaint of the lines of
+     * the visible decorations of a layer.
+     */
+    void updateDecorations(const DecorationLayer &layer);
+
+    /**
+     * @brief Method for painting the visible decorations of
+     * all layers.
+     */
+    void paintDecorations(QPainter &painter);
+
+    /**
+     * @brief Method for painting a decoration, line by line.
+     */
+    void paintDecoration(QPainter &painter, const Decoration &decoration);
+
+    /**
+     * @brief Method for moving the decorations along with
+     * an edit. Only the decorations, that overlap the edit or
+     * lie between it and the previous one, are looked at.
+     */
+    void shiftDecorations(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for painting the extra carets, that are
+     * visible in the viewport.
+     * @param caret Paint carets if true, selections otherwise.
+     */
+    void paintExtraCursors(QPainter &painter, bool caret);
+
+    /**
+     * @brief Method, that performs Alt+Shift+arrow processing,
+     * which extends the rectangular selection.
+     * @param e Pointer to key event.
+     * @return Was the event handled.
+     */
+    bool proceedBlockSelectionKey(QKeyEvent *e);
+
+    /**
+     * @brief Method for getting the visual column at a viewport
+     * position. It may be beyond the end of the line.
+     */
+    int visualColumnAt(const QPoint &pos) const;
+
+    /**
+     * @brief Method for creating the carets of the rectangular
+     * selection.
+     */
+    void updateBlockSelection();
+
+    /**
+     * @brief Method for padding the lines of the rectangular
+     * selection, that end before its left column, with spaces.
+     * Text, that is typed or pasted, then lines up in a column.
+     */
+    void padBlockSelection();
+
+    /**
+     * @brief Method for copying the selections of all carets to
+     * the clipboard, even if the text cursor has no selection.
+     */
+    void copyCursors();
+
+    /**
+     * @brief Method for painting the visible part of the
+     * rectangular selection.
+     */
+    void paintBlockSelection(QPainter &painter);
+
     struct InternalSpan
     {
       public:
@@ -555,19 +1296,106 @@ class QCodeEditor : public QTextEdit
     QLineNumberArea *m_lineNumberArea;
     QCompleter *m_completer;
 
+    QSharedPointer<QCompletionProvider> m_completionProvider;
+    QCompletionEngine *m_completionEngine;
+    QCompleter *m_completionPopup;
+    QStringListModel *m_completionModel;
+
+    struct CompletionPopupWidth
+    {
+        const QCompleter *completer = nullptr;
+        const QAbstractItemModel *model = nullptr;
+        QString prefix;
+
+        /**
+         * @brief Number of rows measured.
+         */
+        int rows = 0;
+
+        int width = 0;
+    };
+
+    CompletionPopupWidth m_completionPopupWidth;
+
     bool m_autoIndentation;
     bool m_replaceTab;
     bool m_extraBottomMargin;
+    bool m_bracketPairColorization;
+    bool m_documentWordCompletion;
     bool m_textChanged;
     QString m_tabReplace;
 
-    QList<QTextEdit::ExtraSelection> m_parenAndCurLineHilits, m_wordOccurHilits;
+    QList<QTextEdit::ExtraSelection> m_parenthesisHilits;
+
+    QMap<QString, DecorationLayer> m_decorationLayers;
 
     QVector<Diagnostic> m_diagnostics;
     lib_interval_tree::interval_tree<InternalSpan> m_diagSpans;
 
     QVector<Parenthesis> m_parentheses;
 
+    /**
+     * @brief Struct, that describes an extra caret by plain
+     * positions. Unlike QTextCursor, that the document updates
+     * on every edit, they're only shifted past an edit.
+     */
+    struct Caret
+    {
+        int anchor;
+        int position;
+
+        int start() const
+        {
+            return qMin(anchor, position);
+        }
+
+        int end() const
+        {
+            return qMax(anchor, position);
+        }
+    };
+
+    QVector<Caret> m_extraCursors;
+    bool m_editingCursors;
+
+    struct BlockSelection
+    {
+        int anchorLine = 0;
+        int anchorColumn = 0;
+        int line = 0;
+        int column = 0;
+    };
+
+    BlockSelection m_blockSelection;
+    bool m_hasBlockSelection;
+    bool m_blockSelecting;
+
     QRegularExpression m_lineStartIndentRegex;
     QRegularExpression m_lineStartCommentRegex;
+
+    // Constructed before the members, that it reports the edits of edit blocks to
+    QUndoHistory *m_undoHistory;
+
+    QSearchEngine *m_wordOccurrences;
+    QString m_wordOccurrenceText;
+
+    QIdentifierIndex *m_identifierIndex;
+
+    struct FoldRegion
+    {
+        QTextCursor start;
+        QTextCursor end;
+    };
+
+    QVector<FoldRegion> m_folds;
+
+    // Index of the fold, that ends last, among the folds up to each one. Edits keep the order of the ends.
+    QVector<int> m_foldMaximumEnds;
+
+    // Lines are shown or hidden, their layout change isn't an edit
+    bool m_changingVisibility;
+
+    QTaskScheduler *m_scheduler;
+
+    QSnippetSession *m_snippetSession;
 };
@@ -0,0 +1,96 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QCompletionProvider.hpp>
+
+// Qt
+#include <QFuture>
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+/**
+ * @brief Class, that runs completion requests of the editor
+ * on the global thread pool. Each request cancels the one
+ * before it, completions of cancelled requests are dropped.
+ */
+class QCompletionEngine : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QCompletionEngine(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Waits for running requests to stop.
+     */
+    ~QCompletionEngine() override;
+
+    // Disable copying
+    QCompletionEngine(const QCompletionEngine &) = delete;
+    QCompletionEngine &operator=(const QCompletionEngine &) = delete;
+
+    /**
+     * @brief Method for starting a request. A running
+     * request is cancelled.
+     * @param provider Provider, that finds the completions.
+     * @param context Where completion was requested.
+     */
+    void request(const QSharedPointer<QCompletionProvider> &provider, const QCompletionProvider::Context &context);
+
+    /**
+     * @brief Method for cancelling the running request.
+     */
+    void cancel();
+
+    /**
+     * @brief Method for getting is a request running.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Method for getting the snippet of a completion
+     * of the last request.
+     * @param completion Label of the snippet.
+     * @return Snippet, empty if the completion is plain text.
+     */
+    QSnippet snippet(const QString &completion) const;
+
+  signals:
+    /**
+     * @brief Signal, a batch of completions arrived. Snippets
+     * are passed by their labels.
+     * @param completions Completions of the batch.
+     * @param first Is it the first batch of the request, that
+     * replaces the completions of the requests before.
+     */
+    void completionsAdded(const QStringList &completions, bool first);
+
+    /**
+     * @brief Signal, the request is finished.
+     * @param count Number of completions of the request.
+     */
+    void finished(int count);
+
+  private:
+    /**
+     * @brief Method for passing on a batch of a request,
+     * unless it belongs to a cancelled one.
+     */
+    void addCompletions(int generation, const QStringList &completions, const QVector<QSnippet> &snippets,
+                        bool last);
+
+    QVector<QFuture<void>> m_requests;
+    std::atomic<int> m_generation;
+    bool m_running;
+    int m_count;
+    QHash<QString, QSnippet> m_snippets;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+// Qt
+#include <QAbstractListModel> // Required for inheritance
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Class, that describes a sorted list of words for
+ * completers. The words are packed into a single buffer, so
+ * several hundred thousand of them stay compact, and a row's
+ * string is only created when its data is asked for. Words,
+ * that start with a prefix, are found by binary search.
+ * @details Set the completer's model sorting and case sensitivity
+ * to the sorting of the model, e.g. CaseSensitivelySortedModel and
+ * Qt::CaseSensitive, so QCompleter filters by binary search too.
+ */
+class QCompletionModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param words Words. Duplicates are removed.
+     * @param sorting Case sensitivity of the order and of the prefix lookup.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QCompletionModel(const QStringList &words = QStringList(),
+                              Qt::CaseSensitivity sorting = Qt::CaseSensitive, QObject *parent = nullptr);
+
+    /**
+     * @brief Method for replacing the words.
+     * @param words Words. Duplicates are removed.
+     */
+    void setWords(const QStringList &words);
+
+    /**
+     * @brief Method for getting the case sensitivity
+     * of the order.
+     */
+    Qt::CaseSensitivity sorting() const;
+
+    /**
+     * @brief Method for getting a word.
+     * @param row Row of the word.
+     */
+    QString word(int row) const;
+
+    /**
+     * @brief Method for getting the rows of the words,
+     * that start with a prefix.
+     * @return First row and the row after the last one.
+     */
+    QPair<int, int> prefixRange(const QString &prefix) const;
+
+    /**
+     * @brief Method for getting the words, that start
+     * with a prefix, in order.
+     * @param limit Maximum number of words, -1 for all.
+     */
+    QStringList wordsWithPrefix(const QString &prefix, int limit = -1) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+  private:
+    /**
+     * @brief Method for comparing a word, cut to the length of
+     * a prefix, with the prefix, without copying the word.
+     * @return Negative, zero or positive, like QString::compare.
+     */
+    int comparePrefix(int row, const QString &prefix) const;
+
+    QString m_text;
+    QVector<int> m_offsets;
+    Qt::CaseSensitivity m_sorting;
+};
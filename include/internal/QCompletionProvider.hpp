@@ -0,0 +1,232 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QFuzzyMatcher.hpp>
+#include <internal/QSnippet.hpp>
+
+// Qt
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Class, that finds completions for the word before
+ * the cursor. Completions are searched on the global thread
+ * pool, so providers must not touch widgets or the document.
+ * See QCodeEditor::setCompletionProvider.
+ */
+class QCompletionProvider
+{
+  public:
+    /**
+     * @brief Struct, that describes an identifier of
+     * the document.
+     */
+    struct DocumentWord
+    {
+        QString word;
+
+        /**
+         * @brief Number of occurrences in the document.
+         */
+        int count;
+
+        /**
+         * @brief Distance in lines of the nearest occurrence
+         * to the cursor.
+         */
+        int distance;
+    };
+
+    /**
+     * @brief Struct, that describes where completion
+     * was requested.
+     */
+    struct Context
+    {
+        /**
+         * @brief Word before the cursor.
+         */
+        QString prefix;
+
+        /**
+         * @brief Text of the line of the cursor.
+         */
+        QString lineText;
+
+        /**
+         * @brief Line of the cursor, starting from 0.
+         */
+        int line;
+
+        /**
+         * @brief Column of the cursor in the line.
+         */
+        int column;
+
+        /**
+         * @brief Was completion requested by the shortcut,
+         * rather than by typing.
+         */
+        bool explicitRequest;
+
+        /**
+         * @brief Identifiers of the document, that contain the
+         * characters of the prefix, without the word being typed.
+         * Empty, unless document word completion is enabled in
+         * the editor.
+         */
+        QVector<DocumentWord> documentWords;
+    };
+
+    /**
+     * @brief Class, that passes the completions of one
+     * request back to the editor.
+     */
+    class Request
+    {
+      public:
+        /**
+         * @brief Constructor.
+         * @param cancelled Function, that tells is the request cancelled.
+         * @param deliver Function, that receives a batch of completions.
+         * @param deliverSnippets Function, that receives a batch of snippets.
+         * Snippets are dropped, if it's empty.
+         */
+        Request(std::function<bool()> cancelled, std::function<void(const QStringList &)> deliver,
+                std::function<void(const QVector<QSnippet> &)> deliverSnippets = {});
+
+        /**
+         * @brief Method for getting was the request cancelled,
+         * because newer keystrokes arrived. Providers should check
+         * it regularly and return early.
+         */
+        bool isCancelled() const;
+
+        /**
+         * @brief Method for adding completions. The popup shows
+         * them right away, after the ones added before.
+         * @param completions Batch of completions.
+         */
+        void addCompletions(const QStringList &completions) const;
+
+        /**
+         * @brief Method for adding snippets. The popup shows their
+         * labels, choosing one expands it with its tab stops.
+         * @param snippets Batch of snippets.
+         */
+        void addSnippets(const QVector<QSnippet> &snippets) const;
+
+      private:
+        std::function<bool()> m_cancelled;
+        std::function<void(const QStringList &)> m_deliver;
+        std::function<void(const QVector<QSnippet> &)> m_deliverSnippets;
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    QCompletionProvider() = default;
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~QCompletionProvider() = default;
+
+    // Disable copying
+    QCompletionProvider(const QCompletionProvider &) = delete;
+    QCompletionProvider &operator=(const QCompletionProvider &) = delete;
+
+    /**
+     * @brief Method for finding the completions of a context.
+     * It's called on the thread pool, the request is finished
+     * once it returns.
+     * @param context Where completion was requested.
+     * @param request Request to add the completions to.
+     */
+    virtual void complete(const Context &context, const Request &request) const = 0;
+};
+
+/**
+ * @brief Class, that completes from a fixed list of words,
+ * e.g. the keywords and functions of a language.
+ */
+class QWordListCompletionProvider : public QCompletionProvider
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param words Words to complete. Duplicates are removed.
+     */
+    explicit QWordListCompletionProvider(const QStringList &words);
+
+    /**
+     * @brief Method for getting the words, sorted.
+     */
+    QStringList words() const;
+
+    void complete(const Context &context, const Request &request) const override;
+
+  private:
+    QStringList m_words;
+};
+
+/**
+ * @brief Class, that completes from a fixed list of words,
+ * which the prefix matches as a subsequence, e.g. nrm finds
+ * normalize. Completions are ranked, the best first.
+ */
+class QFuzzyCompletionProvider : public QCompletionProvider
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param words Words to complete.
+     * @param limit Maximum number of completions of a request.
+     */
+    explicit QFuzzyCompletionProvider(const QStringList &words, int limit = 100);
+
+    /**
+     * @brief Method for getting the maximum number of
+     * completions of a request.
+     */
+    int limit() const;
+
+    void complete(const Context &context, const Request &request) const override;
+
+  private:
+    QFuzzyMatcher m_matcher;
+    int m_limit;
+};
+
+/**
+ * @brief Class, that completes the identifiers of the document,
+ * merged with the completions of another provider, e.g. the
+ * keywords of a language. Identifiers, that occur often and near
+ * the cursor, are ranked higher.
+ */
+class QDocumentWordCompletionProvider : public QCompletionProvider
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param provider Provider to merge with. May be nullptr.
+     * @param limit Maximum number of completions of a request.
+     */
+    explicit QDocumentWordCompletionProvider(
+        const QSharedPointer<QCompletionProvider> &provider = QSharedPointer<QCompletionProvider>(), int limit = 100);
+
+    /**
+     * @brief Method for getting the provider, that's merged with.
+     */
+    QSharedPointer<QCompletionProvider> provider() const;
+
+    void complete(const Context &context, const Request &request) const override;
+
+  private:
+    QSharedPointer<QCompletionProvider> m_provider;
+    int m_limit;
+};
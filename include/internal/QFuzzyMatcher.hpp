@@ -0,0 +1,114 @@
+#pragma once
+
+// Qt
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Class, that ranks a fixed list of candidates by how
+ * well a pattern matches them as a subsequence. Matches at the
+ * start of words, after underscores and at camelCase humps score
+ * higher. The index keeps a character mask per candidate, so
+ * most candidates are rejected without looking at their text,
+ * and a mask of the characters at word starts, that bounds the
+ * score, so candidates, that can't beat the worst kept match,
+ * aren't scored.
+ */
+class QFuzzyMatcher
+{
+  public:
+    /**
+     * @brief Struct, that describes a matching candidate.
+     */
+    struct Match
+    {
+        /**
+         * @brief Index of the candidate.
+         */
+        int index;
+
+        /**
+         * @brief Score of the match, higher is better.
+         */
+        int score;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param candidates Candidates to match against.
+     */
+    explicit QFuzzyMatcher(const QStringList &candidates = QStringList());
+
+    /**
+     * @brief Method for getting the number of candidates.
+     */
+    int count() const;
+
+    /**
+     * @brief Method for getting a candidate.
+     * @param index Index of the candidate.
+     */
+    QString candidate(int index) const;
+
+    /**
+     * @brief Method for finding the best matches of a pattern.
+     * Case is ignored, matching case scores higher.
+     * @param pattern Pattern. An empty one matches the first
+     * candidates with score 0.
+     * @param limit Maximum number of matches.
+     * @param cancelled Function, that tells to stop early. May be empty.
+     * @return Matches, best first. Equal scores prefer shorter candidates.
+     */
+    QVector<Match> match(const QString &pattern, int limit, const std::function<bool()> &cancelled = {}) const;
+
+    /**
+     * @brief Method for scoring one candidate.
+     * @return Score, -1 if the pattern isn't a subsequence of it.
+     */
+    int score(const QString &pattern, int index) const;
+
+    /**
+     * @brief Static method for getting the mask bit of
+     * a lower case character. Candidates, whose mask lacks
+     * a bit of the pattern's, don't match.
+     */
+    static quint64 maskOf(QChar character);
+
+  private:
+    struct Candidate
+    {
+        int offset;
+        int length;
+        quint64 mask;
+
+        /**
+         * @brief Mask of the characters, that get a bonus.
+         */
+        quint64 bonusMask;
+    };
+
+    /**
+     * @brief Static method for getting the highest score, that
+     * a candidate may reach for a pattern.
+     * @param patternMasks Mask bits of the folded pattern.
+     */
+    static int maximumScore(const QVector<quint64> &patternMasks, const Candidate &candidate);
+
+    /**
+     * @brief Method for scoring a candidate against a
+     * folded pattern, that passed the mask test.
+     */
+    int score(const QString &pattern, const QString &foldedPattern, const Candidate &candidate) const;
+
+    QStringList m_candidates;
+
+    // Folded text and bonuses of all candidates, one after another
+    QString m_text;
+    QString m_foldedText;
+    QByteArray m_bonuses;
+
+    QVector<Candidate> m_index;
+};
@@ -1,13 +1,13 @@
 #pragma once
 
-// Qt
-#include <QCompleter> // Required for inheritance
+// QCodeEditor
+#include <internal/QLanguageCompleter.hpp> // Required for inheritance
 
 /**
  * @brief Class, that describes completer with
  * glsl specific types and functions.
  */
-class QGLSLCompleter : public QCompleter
+class QGLSLCompleter : public QLanguageCompleter
 {
     Q_OBJECT
 
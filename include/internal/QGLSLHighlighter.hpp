@@ -1,21 +1,53 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
+class QTextDocument;
 
-class QString;
-class QSyntaxStyle;
+/**
+ * @brief Compile time rule tables of the Glsl highlighter.
+ */
+struct QGLSLLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/glsl.xml";
+    static constexpr const char *keywordPattern = R"(\b%1\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {
+        // Include
+        {R"(#include\s+([<"][a-zA-Z0-9*._]+[">]))", "Preprocessor", 1, "String"},
+        // Function
+        {R"(\b([A-Za-z0-9_]+(?:\s+|::))*([A-Za-z0-9_]+)(?=\())", "Type", 2, "Function"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"(\b(0b|0x){0,1}[\d.']+\b)", "Number"},
+        // Define
+        {R"(#[a-zA-Z_]+)", "Preprocessor"},
+        // Single line
+        {R"(//[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline comments
+        {R"(/\*)", R"(\*/)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "//";
+    static constexpr const char *commentBlockStart = "/*";
+    static constexpr const char *commentBlockEnd = "*/";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
 
 /**
  * @brief Class, that describes Glsl code
  * highlighter.
  */
-class QGLSLHighlighter : public QStyleSyntaxHighlighter
+class QGLSLHighlighter : public QRuleHighlighter<QGLSLLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -24,17 +56,4 @@ class QGLSLHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QGLSLHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-
-    QRegularExpression m_includePattern;
-    QRegularExpression m_functionPattern;
-    QRegularExpression m_defTypePattern;
-
-    QRegularExpression m_commentStartPattern;
-    QRegularExpression m_commentEndPattern;
 };
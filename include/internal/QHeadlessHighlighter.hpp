@@ -0,0 +1,93 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QHighlightToken.hpp>
+
+// Qt
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+class QStyleSyntaxHighlighter;
+class QSyntaxStyle;
+
+/**
+ * @brief Class, that runs the tokenizer of a highlighter
+ * without a widget or a QTextDocument, e.g. for rendering
+ * code to HTML or ANSI escaped text on a server.
+ * @details All methods are const and thread safe, as long as
+ * the highlighter and the style are not modified meanwhile.
+ */
+class QHeadlessHighlighter
+{
+  public:
+    /**
+     * @brief Output format of rendering.
+     */
+    enum class OutputFormat
+    {
+        Html,
+        Ansi
+    };
+
+    /**
+     * @brief Constructor.
+     * @param highlighter Highlighter, whose tokenizer is used.
+     * It doesn't need a document.
+     * @param style Syntax style used for rendering. May be nullptr
+     * if only tokens are required.
+     */
+    QHeadlessHighlighter(const QStyleSyntaxHighlighter *highlighter, const QSyntaxStyle *style);
+
+    /**
+     * @brief Method for tokenizing text.
+     * @param text Text, lines may be separated by LF or CRLF.
+     * @return Non overlapping tokens of each line.
+     */
+    QVector<QVector<QHighlightToken>> tokenize(QStringView text) const;
+
+    /**
+     * @brief Method for rendering text.
+     * @param text Text, lines may be separated by LF or CRLF.
+     * @param format Output format.
+     * @return HTML (a single <pre> element) or text with ANSI escape sequences.
+     */
+    QString render(QStringView text, OutputFormat format) const;
+
+    /**
+     * @brief Method for rendering a UTF-8 encoded file.
+     * @param path Path of the file.
+     * @param format Output format.
+     * @return Rendered text, empty if the file can't be read.
+     */
+    QString renderFile(const QString &path, OutputFormat format) const;
+
+    /**
+     * @brief Method for rendering many files on the global
+     * thread pool.
+     * @param paths Paths of the files.
+     * @param format Output format.
+     * @return Rendered text of each file, in the order of paths.
+     */
+    QStringList renderFiles(const QStringList &paths, OutputFormat format) const;
+
+  private:
+    /**
+     * @brief Method for splitting text into lines without the
+     * line terminators.
+     */
+    static QVector<QStringView> splitLines(QStringView text);
+
+    /**
+     * @brief Method for tokenizing lines, carrying the
+     * state of each line over to the next one.
+     */
+    QVector<QVector<QHighlightToken>> tokenizeLines(const QVector<QStringView> &lines) const;
+
+    QString renderHtml(const QVector<QStringView> &lines, const QVector<QVector<QHighlightToken>> &tokens) const;
+    QString renderAnsi(const QVector<QStringView> &lines, const QVector<QVector<QHighlightToken>> &tokens) const;
+
+    const QStyleSyntaxHighlighter *m_highlighter;
+    const QSyntaxStyle *m_style;
+};
@@ -1,19 +1,34 @@
 #pragma once
 
+#include <utility>
+
 // Qt
 #include <QRegularExpression>
 #include <QString>
 
 struct QHighlightRule
 {
-    QHighlightRule() : pattern(), formatName()
+    QHighlightRule() : pattern(), formatName(), capture(0), captureFormatName()
     {
     }
 
-    QHighlightRule(QRegularExpression p, QString f) : pattern(std::move(p)), formatName(std::move(f))
+    QHighlightRule(QRegularExpression p, QString f)
+        : pattern(std::move(p)), formatName(std::move(f)), capture(0), captureFormatName()
+    {
+    }
+
+    QHighlightRule(QRegularExpression p, QString f, int c, QString cf)
+        : pattern(std::move(p)), formatName(std::move(f)), capture(c), captureFormatName(std::move(cf))
     {
     }
 
     QRegularExpression pattern;
     QString formatName;
+
+    /**
+     * @brief Capture group, that is additionally
+     * highlighted with captureFormatName.
+     */
+    int capture;
+    QString captureFormatName;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <utility>
+
+// Qt
+#include <QString>
+
+/**
+ * @brief Struct, that describes a single highlighted
+ * span produced by a highlighter tokenizer.
+ */
+struct QHighlightToken
+{
+    QHighlightToken() : start(0), length(0), formatName(), code(true)
+    {
+    }
+
+    // qsizetype, so braced construction from QRegularExpressionMatch offsets doesn't narrow with Qt 6
+    QHighlightToken(qsizetype s, qsizetype l, QString f)
+        : start(static_cast<int>(s)), length(static_cast<int>(l)), formatName(std::move(f)), code(true)
+    {
+    }
+
+    friend bool operator==(const QHighlightToken &lhs, const QHighlightToken &rhs)
+    {
+        return lhs.start == rhs.start && lhs.length == rhs.length && lhs.formatName == rhs.formatName;
+    }
+
+    friend bool operator!=(const QHighlightToken &lhs, const QHighlightToken &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    int start;
+    int length;
+    QString formatName;
+
+    /**
+     * @brief Is the span code. The highlighter clears it for
+     * strings and comments, whose brackets aren't matched.
+     */
+    bool code;
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+// Qt
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+/**
+ * @brief Class, that maps each identifier of a document to
+ * the places it occurs at. Only the edited lines are rescanned,
+ * when the document changes.
+ */
+class QIdentifierIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Struct, that describes an occurrence of an identifier.
+     */
+    struct Occurrence
+    {
+        int line;
+        int column;
+    };
+
+    /**
+     * @brief Struct, that describes an identifier and its
+     * occurrences relative to a line.
+     */
+    struct Summary
+    {
+        QString identifier;
+
+        /**
+         * @brief Number of occurrences.
+         */
+        int count;
+
+        /**
+         * @brief Distance in lines of the nearest occurrence.
+         */
+        int distance;
+    };
+
+    /**
+     * @brief Constructor. Indexes the current text of the document.
+     * @param document Document to index.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QIdentifierIndex(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~QIdentifierIndex() override;
+
+    // Disable copying
+    QIdentifierIndex(const QIdentifierIndex &) = delete;
+    QIdentifierIndex &operator=(const QIdentifierIndex &) = delete;
+
+    /**
+     * @brief Method for setting what an identifier is.
+     * The document is indexed again.
+     * @param pattern Regular expression. Default is
+     * [_a-zA-Z][_a-zA-Z0-9]*
+     */
+    void setIdentifierPattern(const QRegularExpression &pattern);
+
+    /**
+     * @brief Method for getting the identifier pattern.
+     */
+    QRegularExpression identifierPattern() const;
+
+    /**
+     * @brief Method for getting all identifiers of the
+     * document, in no particular order.
+     */
+    QStringList identifiers() const;
+
+    /**
+     * @brief Method for getting the number of different
+     * identifiers in the document.
+     */
+    int identifierCount() const;
+
+    /**
+     * @brief Method for getting the number of occurrences
+     * of an identifier.
+     */
+    int occurrenceCount(const QString &identifier) const;
+
+    /**
+     * @brief Method for getting all occurrences of an identifier.
+     * @return Occurrences sorted by line and column.
+     */
+    QVector<Occurrence> occurrences(const QString &identifier) const;
+
+    /**
+     * @brief Method for getting the occurrences of an identifier
+     * in a range of lines, found by binary search.
+     * @param firstLine First block number, inclusive.
+     * @param lastLine Last block number, inclusive.
+     * @return Occurrences sorted by line and column.
+     */
+    QVector<Occurrence> occurrencesInLines(const QString &identifier, int firstLine, int lastLine) const;
+
+    /**
+     * @brief Method for getting the distance in lines from a line
+     * to the nearest occurrence of an identifier, found by binary search.
+     * @param line Block number.
+     * @return Distance, -1 if the identifier doesn't occur.
+     */
+    int distanceToNearestOccurrence(const QString &identifier, int line) const;
+
+    /**
+     * @brief Method for getting the identifiers, that may match
+     * a pattern as a subsequence, ignoring case. Identifiers, that
+     * lack one of its characters, are rejected by a character mask,
+     * see QFuzzyMatcher.
+     * @param line Block number, the distances are measured from.
+     * @return Identifiers in no particular order.
+     */
+    QVector<Summary> identifiersMatching(const QString &pattern, int line) const;
+
+    /**
+     * @brief Method for getting the approximate number of bytes
+     * used by the index.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Method for indexing the whole document again.
+     */
+    void rebuild();
+
+  signals:
+    /**
+     * @brief Signal, an identifier appeared in the document
+     * or its last occurrence was removed.
+     */
+    void identifiersChanged();
+
+  private slots:
+    /**
+     * @brief Slot, that replaces the index entries of the
+     * changed lines.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    struct Chunk;
+
+    struct Line
+    {
+        Chunk *chunk;
+        int index;
+        size_t hash;
+        QStringList identifiers;
+    };
+
+    /**
+     * @brief Struct, that describes consecutive lines. Lines are
+     * numbered relative to their chunk, so an edit renumbers the
+     * lines of one chunk and shifts the chunks after it.
+     */
+    struct Chunk
+    {
+        int first;
+        QVector<Line *> lines;
+    };
+
+    struct Posting
+    {
+        Line *line;
+        int column;
+    };
+
+    /**
+     * @brief Struct, that describes the occurrences of an
+     * identifier, sorted by line and column.
+     */
+    struct Identifier
+    {
+        quint64 mask;
+        QVector<Posting> postings;
+    };
+
+    /**
+     * @brief Static method for getting the distance in lines from
+     * a line to the nearest posting, found by binary search.
+     * @return Distance, -1 if there is no posting.
+     */
+    static int distanceOf(const QVector<Posting> &postings, int line);
+
+    /**
+     * @brief Struct, that describes an identifier and its
+     * occurrences relative to a line.
+     */
+    struct Summary
+    {
+        QString identifier;
+
+        /**
+         * @brief Number of occurrences.
+         */
+        int count;
+
+        /**
+         * @brief Distance in lines of the nearest occurrence.
+         */
+        int distance;
+    };
+
+    /**
+     * @brief Static method for getting the block number of a line.
+     */
+    static int numberOf(const Line *line);
+
+    /**
+     * @brief Method for finding the chunk of a line by binary search.
+     * @return Index of the chunk.
+     */
+    int chunkAt(int number) const;
+
+    /**
+     * @brief Method for getting the line with a block number.
+     */
+    Line *lineAt(int number) const;
+
+    /**
+     * @brief Method for replacing lines by the lines of new blocks.
+     * @param firstLine Number of the first replaced line.
+     * @param oldCount Number of replaced lines.
+     * @param block First new block.
+     * @param newCount Number of new blocks.
+     * @return Did the identifiers of the document change.
+     */
+    bool replaceLines(int firstLine, int oldCount, QTextBlock block, int newCount);
+
+    /**
+     * @brief Method for numbering the lines of a range of chunks
+     * and updating the first line of the chunks from it on.
+     */
+    void renumber(int firstChunk, int lastChunk);
+
+    /**
+     * @brief Method for deleting all lines and chunks.
+     */
+    void clearLines();
+
+    /**
+     * @brief Method for adding the postings of a line.
+     * @return Is there a new identifier.
+     */
+    bool addPostings(Line *line, const QString &text);
+
+    /**
+     * @brief Method for removing the postings of a line.
+     * @return Was the last occurrence of an identifier removed.
+     */
+    bool removePostings(Line *line);
+
+    QTextDocument *m_document;
+    QRegularExpression m_pattern;
+    QVector<Chunk *> m_chunks;
+    int m_lineCount;
+    QHash<QString, Identifier> m_identifiers;
+};
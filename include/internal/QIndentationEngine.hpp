@@ -0,0 +1,157 @@
+#pragma once
+
+// Qt
+#include <QString>
+
+class QCodeBlockData;
+class QTextBlock;
+
+/**
+ * @brief Class, that computes the indentation of lines from
+ * the lines before them. The default implementation nests
+ * lines by the brackets, that the highlighter recorded in
+ * the block data. Highlighters provide an engine for their
+ * language, see QStyleSyntaxHighlighter::setIndentationEngine.
+ */
+class QIndentationEngine
+{
+  public:
+    /**
+     * @brief Constructor.
+     */
+    QIndentationEngine() = default;
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~QIndentationEngine() = default;
+
+    // Disable copying
+    QIndentationEngine(const QIndentationEngine &) = delete;
+    QIndentationEngine &operator=(const QIndentationEngine &) = delete;
+
+    /**
+     * @brief Method for computing the indentation of a line.
+     * The lines before it are expected to be highlighted.
+     * @param block Line.
+     * @param tabSize Width of a tab and of an indentation level.
+     * @return Indentation in columns, -1 if the line keeps its
+     * own, e.g. inside a multi line comment.
+     */
+    virtual int indentation(const QTextBlock &block, int tabSize) const;
+
+    /**
+     * @brief Method for getting does the indentation carry
+     * meaning, like in Python. Several lines are then shifted
+     * together, keeping their relative indentation.
+     */
+    virtual bool isIndentationSignificant() const;
+
+    /**
+     * @brief Method for getting should a line be indented
+     * again, after a character was typed.
+     * @param text Text of the line up to the cursor.
+     */
+    virtual bool isElectric(const QString &text) const;
+
+    /**
+     * @brief Static method for getting the indentation
+     * of a text in columns.
+     * @return Indentation, -1 for blank text.
+     */
+    static int indentationOf(const QString &text, int tabSize);
+
+  protected:
+    /**
+     * @brief Struct, that describes how a line changes
+     * the nesting.
+     */
+    struct LineNesting
+    {
+        /**
+         * @brief Change of the nesting by the whole line.
+         */
+        int delta;
+
+        /**
+         * @brief Closing brackets or words, that come first
+         * in the line and unindent the line itself.
+         */
+        int leadingCloses;
+    };
+
+    /**
+     * @brief Method for measuring the nesting of a line.
+     * Default implementation counts the brackets of the block
+     * data, or of the text, if the block wasn't highlighted.
+     */
+    virtual LineNesting nesting(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting does nesting() only count the
+     * brackets of the block data. The lines before a line are
+     * then skipped by the bracket index of the document, instead
+     * of looked at one by one. Default is true.
+     */
+    virtual bool isNestedByBrackets() const;
+
+    /**
+     * @brief Method for indenting a line relative to the
+     * nearest line before it, that is nested less or as deep.
+     * Lines are measured with nesting().
+     * @param level Nesting of the line relative to its start.
+     * @return Indentation, -1 if no such line was found nearby,
+     * when the lines are looked at one by one.
+     */
+    int nestedIndentation(const QTextBlock &block, int level, int tabSize) const;
+
+    /**
+     * @brief Static method for getting does a line start
+     * inside a multi line comment or string.
+     */
+    static bool startsInsideToken(const QTextBlock &block);
+
+    /**
+     * @brief Static method for getting is a character code,
+     * not part of a string or a comment.
+     * @param data Block data. May be nullptr.
+     */
+    static bool isCode(const QCodeBlockData *data, int position);
+
+    /**
+     * @brief Static method for getting is a character a
+     * closing bracket of the block data, or of the default
+     * pairs, if the block wasn't highlighted.
+     * @param data Block data. May be nullptr.
+     */
+    static bool isClosingBracket(const QCodeBlockData *data, QChar character);
+};
+
+/**
+ * @brief Class, that indents Python code after colons and
+ * unindents after statements, that leave a block.
+ */
+class QPythonIndentationEngine : public QIndentationEngine
+{
+  public:
+    int indentation(const QTextBlock &block, int tabSize) const override;
+
+    bool isIndentationSignificant() const override;
+
+    bool isElectric(const QString &text) const override;
+};
+
+/**
+ * @brief Class, that nests Lua code by the brackets and by
+ * the words, that open and close blocks, e.g. then and end.
+ */
+class QLuaIndentationEngine : public QIndentationEngine
+{
+  public:
+    bool isElectric(const QString &text) const override;
+
+  protected:
+    LineNesting nesting(const QTextBlock &block) const override;
+
+    bool isNestedByBrackets() const override;
+};
@@ -1,23 +1,49 @@
 #pragma once
 
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+// QCodeEditor
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
-
-class QSyntaxStyle;
 class QTextDocument;
-class QString;
+
+/**
+ * @brief Compile time rule tables of the JavaScript highlighter.
+ */
+struct QJSLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/js.xml";
+    static constexpr const char *keywordPattern = R"(\b%1\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {};
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"((?<=\b|\s|^)(?i)(?:(?:(?:(?:(?:\d+(?:'\d+)*)?\.(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)\.(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)?\.(?:[0-9a-f]+(?:'[0-9a-f]+)*)(?:p[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)\.?(?:p[+-]?(?:\d+(?:'\d+)*))))[lf]?)|(?:(?:(?:[1-9]\d*(?:'\d+)*)|(?:0[0-7]*(?:'[0-7]+)*)|(?:0x[0-9a-f]+(?:'[0-9a-f]+)*)|(?:0b[01]+(?:'[01]+)*))(?:u?l{0,2}|l{0,2}u?)))(?=\b|\s|$))", "Number"},
+        // Strings
+        {R"("[^\n"]*")", "String"},
+        // Single line
+        {R"(//[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline comments
+        {R"(/\*)", R"(\*/)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "//";
+    static constexpr const char *commentBlockStart = "/*";
+    static constexpr const char *commentBlockEnd = "*/";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
 
 /**
  * @brief Derived to implement highlighting of JavaScript code.
  */
-class QJSHighlighter : public QStyleSyntaxHighlighter
+class QJSHighlighter : public QRuleHighlighter<QJSLanguagePolicy>
 {
     Q_OBJECT
-
   public:
     /**
      * @brief Constructs a new instance of a JavaScript highlighter.
@@ -25,13 +51,4 @@ class QJSHighlighter : public QStyleSyntaxHighlighter
      * This may be a null pointer.
      */
     explicit QJSHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-
-    QRegularExpression m_commentStartPattern;
-    QRegularExpression m_commentEndPattern;
 };
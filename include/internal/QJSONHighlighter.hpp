@@ -1,21 +1,48 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
-
-class QString;
 class QTextDocument;
 
+/**
+ * @brief Compile time rule tables of the JSON highlighter.
+ */
+struct QJSONLanguagePolicy
+{
+    static constexpr const char *languageFile = nullptr;
+    static constexpr const char *keywordPattern = nullptr;
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {};
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Keywords
+        {R"(\b(?:null|true|false)\b)", "Keyword"},
+        // Numbers
+        {R"(\b(0b|0x){0,1}[\d.']+\b)", "Number"},
+        // Strings
+        {R"("[^\n"]*")", "String"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {};
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {
+        // Keys
+        {R"(("[^\r\n:]+?")\s*:)", nullptr, 1, "Keyword"},
+    };
+
+    static constexpr const char *commentLine = "";
+    static constexpr const char *commentBlockStart = "";
+    static constexpr const char *commentBlockEnd = "";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
+
 /**
  * @brief Class, that describes JSON code
  * highlighter.
  */
-class QJSONHighlighter : public QStyleSyntaxHighlighter
+class QJSONHighlighter : public QRuleHighlighter<QJSONLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -24,11 +51,4 @@ class QJSONHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QJSONHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-    QRegularExpression m_keyRegex;
 };
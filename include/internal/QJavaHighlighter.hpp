@@ -1,21 +1,47 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
-
-class QString;
 class QTextDocument;
-class QSyntaxStyle;
+
+/**
+ * @brief Compile time rule tables of the Java highlighter.
+ */
+struct QJavaLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/java.xml";
+    static constexpr const char *keywordPattern = R"(\b%1\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {};
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"((?<=\b|\s|^)(?i)(?:(?:[0-9]+\.[0-9]*(?:e[+-]?[0-9]+)?[fd]?)|(?:\.[0-9]+(?:e[+-]?[0-9]+)?[fd]?)|(?:[0-9]+(?:e[+-]?[0-9]+)[fd]?)|(?:[0-9]+(?:e[+-]?[0-9]+)?[fd])|(?:(?:(?:0x[0-9a-f]+\.?)|(?:0x[0-9a-f]*\.[0-9a-f]+))p[+-]?[0-9]+[fd]?)|(?:0)|(?:[1-9][0-9]*)|(?:0x[0-9a-f]+)|(?:0[0-7]+))(?=\b|\s|$))", "Number"},
+        // Strings
+        {R"("[^\n"]*")", "String"},
+        // Single line
+        {R"(//[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline comments
+        {R"(/\*)", R"(\*/)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "//";
+    static constexpr const char *commentBlockStart = "/*";
+    static constexpr const char *commentBlockEnd = "*/";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
 
 /**
  * @brief Derived to implement highlighting of Java code.
  */
-class QJavaHighlighter : public QStyleSyntaxHighlighter
+class QJavaHighlighter : public QRuleHighlighter<QJavaLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -25,17 +51,4 @@ class QJavaHighlighter : public QStyleSyntaxHighlighter
      * This may be a null pointer.
      */
     explicit QJavaHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    /**
-     * @brief Derived to highlight blocks of Java code.
-     * @param text The block of text containing Java code.
-     */
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-
-    QRegularExpression m_commentStartPattern;
-    QRegularExpression m_commentEndPattern;
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+// Qt
+#include <QCompleter> // Required for inheritance
+#include <QSharedPointer>
+
+class QCompletionProvider;
+
+/**
+ * @brief Class, that describes completer with the
+ * names of a language file. In QCodeEditor the names
+ * are matched fuzzily and asynchronously by its completion
+ * provider.
+ */
+class QLanguageCompleter : public QCompleter
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param languageFile Path to language file, e.g. ":/languages/lua.xml".
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QLanguageCompleter(const QString &languageFile, QObject *parent = nullptr);
+
+    /**
+     * @brief Method for getting the provider, that completes
+     * the names of the language.
+     * @return Pointer to provider. May be nullptr, if the
+     * language file couldn't be loaded.
+     */
+    QSharedPointer<QCompletionProvider> completionProvider() const;
+
+  private:
+    QSharedPointer<QCompletionProvider> m_completionProvider;
+};
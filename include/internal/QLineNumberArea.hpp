@@ -9,6 +9,8 @@
 
 class QSyntaxStyle;
 class QPaintEvent;
+class QMouseEvent;
+class QPainter;
 
 /**
  * @brief Class, that describes line number area widget.
@@ -58,9 +60,27 @@ class QLineNumberArea : public QWidget
   protected:
     void paintEvent(QPaintEvent *event) override;
 
+    /**
+     * @brief Method, that folds or unfolds the line, whose
+     * fold marker is clicked.
+     */
+    void mousePressEvent(QMouseEvent *event) override;
+
   private:
     QFont::Weight intToFontWeight(int v);
 
+    /**
+     * @brief Method for getting the width of the fold
+     * marker column at the right edge.
+     */
+    int foldMarkerWidth() const;
+
+    /**
+     * @brief Method for painting the fold marker of a line.
+     * @param folded Is the line folded.
+     */
+    void paintFoldMarker(QPainter &painter, const QRect &rect, bool folded) const;
+
 
     QSyntaxStyle *m_syntaxStyle;
 
@@ -1,13 +1,13 @@
 #pragma once
 
-// Qt
-#include <QCompleter> // Required for inheritance
+// QCodeEditor
+#include <internal/QLanguageCompleter.hpp> // Required for inheritance
 
 /**
  * @brief Class, that describes completer with
  * Lua specific types and functions.
  */
-class QLuaCompleter : public QCompleter
+class QLuaCompleter : public QLanguageCompleter
 {
     Q_OBJECT
 
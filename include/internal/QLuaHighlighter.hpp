@@ -1,24 +1,59 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
-#include <internal/QHighlightBlockRule.hpp>
-#include <internal/QHighlightRule.hpp>
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QMap>
-#include <QRegularExpression>
-#include <QVector>
-
-class QString;
 class QTextDocument;
-class QSyntaxStyle;
+
+/**
+ * @brief Compile time rule tables of the Lua highlighter.
+ */
+struct QLuaLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/lua.xml";
+    static constexpr const char *keywordPattern = R"(\b\s{0,1}%1\s{0,1}\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {
+        // Require
+        {R"(require\s*([("'][a-zA-Z0-9*._]+['")]))", "Preprocessor", 1, "String"},
+        // Function
+        {R"(\b([A-Za-z0-9_]+(?:\s+|::))*([A-Za-z0-9_]+)(?=\())", "Type", 2, "Function"},
+        // Type of definition
+        {R"(\b([A-Za-z0-9_]+)\s+[A-Za-z]{1}[A-Za-z0-9_]+\s*[=])", nullptr, 1, "Type"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"(\b(0b|0x){0,1}[\d.']+\b)", "Number"},
+        // Strings
+        {R"(["'][^\n"]*["'])", "String"},
+        // Preprocessor
+        {R"(#\![a-zA-Z_]+)", "Preprocessor"},
+        // Single line
+        {R"(--[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline comments
+        {R"(--\[\[)", R"(--\]\])", "Comment"},
+        // Multiline string
+        {R"(\[\[)", R"(\]\])", "String"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "--";
+    static constexpr const char *commentBlockStart = "--[[";
+    static constexpr const char *commentBlockEnd = "]]";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Indentation;
+    using indentation = QLuaIndentationEngine;
+};
 
 /**
  * @brief Class, that describes Lua code
  * highlighter.
  */
-class QLuaHighlighter : public QStyleSyntaxHighlighter
+class QLuaHighlighter : public QRuleHighlighter<QLuaLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -27,15 +62,4 @@ class QLuaHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QLuaHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-    QVector<QHighlightBlockRule> m_highlightBlockRules;
-
-    QRegularExpression m_requirePattern;
-    QRegularExpression m_functionPattern;
-    QRegularExpression m_defTypePattern;
 };
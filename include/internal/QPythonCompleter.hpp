@@ -1,13 +1,13 @@
 #pragma once
 
-// Qt
-#include <QCompleter> // Required for inheritance
+// QCodeEditor
+#include <internal/QLanguageCompleter.hpp> // Required for inheritance
 
 /**
  * @brief Class, that describes completer with
  * Python specific types and functions.
  */
-class QPythonCompleter : public QCompleter
+class QPythonCompleter : public QLanguageCompleter
 {
     Q_OBJECT
 
@@ -1,23 +1,53 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QHighlightBlockRule.hpp>
-#include <internal/QHighlightRule.hpp>
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
-// Qt
-#include <QRegularExpression>
-#include <QVector>
-
-class QString;
 class QTextDocument;
-class QSyntaxStyle;
+
+/**
+ * @brief Compile time rule tables of the Python highlighter.
+ */
+struct QPythonLanguagePolicy
+{
+    static constexpr const char *languageFile = ":/languages/python.xml";
+    static constexpr const char *keywordPattern = R"(\b%1\b)";
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {
+        // Function
+        {R"(\b([A-Za-z0-9_]+(?:\.))*([A-Za-z0-9_]+)(?=\())", "Type", 2, "Function"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Numbers
+        {R"(\b(0b|0x){0,1}[\d.']+\b)", "Number"},
+        // Strings
+        {R"("[^\n"]*")", "String"},
+        {R"('[^\n"]*')", "String"},
+        // Single line comment
+        {R"(#[^\n]*)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Multiline string
+        {R"(''')", R"(''')", "String"},
+        {R"(""")", R"(""")", "String"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {};
+
+    static constexpr const char *commentLine = "#";
+    static constexpr const char *commentBlockStart = "'''";
+    static constexpr const char *commentBlockEnd = "'''";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Indentation;
+    using indentation = QPythonIndentationEngine;
+};
 
 /**
  * @brief Class, that describes Python code
  * highlighter.
  */
-class QPythonHighlighter : public QStyleSyntaxHighlighter
+class QPythonHighlighter : public QRuleHighlighter<QPythonLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -26,15 +56,4 @@ class QPythonHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QPythonHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    QVector<QHighlightRule> m_highlightRules;
-    QVector<QHighlightBlockRule> m_highlightBlockRules;
-
-    QRegularExpression m_includePattern;
-    QRegularExpression m_functionPattern;
-    QRegularExpression m_defTypePattern;
 };
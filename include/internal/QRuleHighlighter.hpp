@@ -0,0 +1,266 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QHighlightBlockRule.hpp>
+#include <internal/QHighlightRule.hpp>
+#include <internal/QHighlightToken.hpp>
+#include <internal/QIndentationEngine.hpp>
+#include <internal/QLanguage.hpp>
+#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
+
+// Qt
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+
+#include <initializer_list>
+
+class QTextDocument;
+
+/**
+ * @brief Struct, that describes a highlight rule as
+ * compile time data of a language policy.
+ */
+struct QHighlightRuleDefinition
+{
+    /**
+     * @brief Regular expression.
+     */
+    const char *pattern;
+
+    /**
+     * @brief Format of the whole match. May be nullptr.
+     */
+    const char *formatName;
+
+    /**
+     * @brief Capture group highlighted with captureFormatName.
+     */
+    int capture = 0;
+
+    /**
+     * @brief Format of the capture group. May be nullptr.
+     */
+    const char *captureFormatName = nullptr;
+};
+
+/**
+ * @brief Struct, that describes a multi line highlight
+ * rule as compile time data of a language policy.
+ */
+struct QHighlightBlockRuleDefinition
+{
+    const char *startPattern;
+    const char *endPattern;
+    const char *formatName;
+};
+
+/**
+ * @brief Class template, that implements the rule based
+ * scan loop shared by the built-in highlighters.
+ *
+ * A language policy is a struct with the following static
+ * constexpr members:
+ * - languageFile: keyword resource (see QLanguage), may be nullptr.
+ * - keywordPattern: pattern for keywords, %1 is replaced by an
+ *   alternation of all names of one section.
+ * - preRules: rules applied before keywords.
+ * - rules: rules applied after keywords.
+ * - blockRules: multi line rules, the block state is the index
+ *   of the open rule plus one.
+ * - postRules: rules applied after multi line rules.
+ * - commentLine, commentBlockStart, commentBlockEnd: sequences
+ *   for comment toggling, may be empty.
+ * - folding: how foldable regions are found.
+ * - indentation: type of the indentation engine.
+ *
+ * Rules are compiled once per highlighter instance. Keywords of
+ * one section share a single expression, instead of one per name.
+ */
+template <typename Language>
+class QRuleHighlighter : public QStyleSyntaxHighlighter
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Pointer to document.
+     */
+    explicit QRuleHighlighter(QTextDocument *document = nullptr);
+
+    int tokenizeBlock(const QString &text, int previousState, QVector<QHighlightToken> &tokens) const override;
+
+  private:
+    static QVector<QHighlightRule> compileRules(std::initializer_list<QHighlightRuleDefinition> definitions);
+
+    static void applyRules(const QVector<QHighlightRule> &rules, const QString &text,
+                           QVector<QHighlightToken> &tokens);
+
+    int applyBlockRules(const QString &text, int previousState, QVector<QHighlightToken> &tokens) const;
+
+    QVector<QHighlightRule> m_preRules;
+    QVector<QHighlightRule> m_rules;
+    QVector<QHighlightBlockRule> m_blockRules;
+    QVector<QHighlightRule> m_postRules;
+};
+
+template <typename Language>
+QRuleHighlighter<Language>::QRuleHighlighter(QTextDocument *document)
+    : QStyleSyntaxHighlighter(document), m_preRules(compileRules(Language::preRules)), m_rules(), m_blockRules(),
+      m_postRules(compileRules(Language::postRules))
+{
+    if (Language::languageFile != nullptr)
+    {
+        Q_INIT_RESOURCE(qcodeeditor_resources);
+        QFile fl(Language::languageFile);
+
+        if (fl.open(QIODevice::ReadOnly))
+        {
+            QLanguage language(&fl);
+
+            if (language.isLoaded())
+            {
+                auto keys = language.keys();
+                for (auto &&key : keys)
+                {
+                    auto names = language.names(key);
+                    if (names.isEmpty())
+                    {
+                        continue;
+                    }
+
+                    auto alternation = "(?:" + names.join('|') + ")";
+                    m_rules.append({QRegularExpression(QString(Language::keywordPattern).arg(alternation)), key});
+                }
+            }
+        }
+    }
+
+    // Following rules have higher priority to display
+    // than language specific keys, so they are applied last.
+    m_rules.append(compileRules(Language::rules));
+
+    for (auto &&definition : Language::blockRules)
+    {
+        m_blockRules.append({QRegularExpression(definition.startPattern), QRegularExpression(definition.endPattern),
+                             definition.formatName});
+    }
+
+    // Comment sequences for toggling support
+    m_commentLineSequence = Language::commentLine;
+    m_startCommentBlockSequence = Language::commentBlockStart;
+    m_endCommentBlockSequence = Language::commentBlockEnd;
+
+    setFoldingStyle(Language::folding);
+    setIndentationEngine(QSharedPointer<typename Language::indentation>::create());
+}
+
+template <typename Language>
+int QRuleHighlighter<Language>::tokenizeBlock(const QString &text, int previousState,
+                                              QVector<QHighlightToken> &tokens) const
+{
+    applyRules(m_preRules, text, tokens);
+    applyRules(m_rules, text, tokens);
+    auto state = applyBlockRules(text, previousState, tokens);
+    applyRules(m_postRules, text, tokens);
+
+    return state;
+}
+
+template <typename Language>
+QVector<QHighlightRule> QRuleHighlighter<Language>::compileRules(
+    std::initializer_list<QHighlightRuleDefinition> definitions)
+{
+    QVector<QHighlightRule> rules;
+    rules.reserve(static_cast<int>(definitions.size()));
+
+    for (auto &&definition : definitions)
+    {
+        rules.append({QRegularExpression(definition.pattern), QString(definition.formatName), definition.capture,
+                      QString(definition.captureFormatName)});
+    }
+
+    return rules;
+}
+
+template <typename Language>
+void QRuleHighlighter<Language>::applyRules(const QVector<QHighlightRule> &rules, const QString &text,
+                                            QVector<QHighlightToken> &tokens)
+{
+    for (auto &&rule : rules)
+    {
+        auto matchIterator = rule.pattern.globalMatch(text);
+
+        while (matchIterator.hasNext())
+        {
+            auto match = matchIterator.next();
+
+            if (!rule.formatName.isEmpty())
+            {
+                tokens.append({match.capturedStart(), match.capturedLength(), rule.formatName});
+            }
+
+            if (!rule.captureFormatName.isEmpty())
+            {
+                tokens.append(
+                    {match.capturedStart(rule.capture), match.capturedLength(rule.capture), rule.captureFormatName});
+            }
+        }
+    }
+}
+
+template <typename Language>
+int QRuleHighlighter<Language>::applyBlockRules(const QString &text, int previousState,
+                                                QVector<QHighlightToken> &tokens) const
+{
+    int ruleIndex = previousState - 1;
+    bool continued = ruleIndex >= 0 && ruleIndex < m_blockRules.size();
+    int position = 0;
+
+    while (position <= text.length())
+    {
+        int start = 0;
+        int startLength = 0;
+
+        if (continued)
+        {
+            continued = false;
+        }
+        else
+        {
+            // Find the earliest start of any multi line rule
+            start = -1;
+            for (int i = 0; i < m_blockRules.size(); ++i)
+            {
+                QRegularExpressionMatch match;
+                auto index = text.indexOf(m_blockRules.at(i).startPattern, position, &match);
+
+                if (index >= 0 && (start < 0 || index < start))
+                {
+                    start = index;
+                    startLength = match.capturedLength();
+                    ruleIndex = i;
+                }
+            }
+
+            if (start < 0)
+            {
+                break;
+            }
+        }
+
+        const auto &rule = m_blockRules.at(ruleIndex);
+        auto match = rule.endPattern.match(text, start + startLength);
+
+        if (!match.hasMatch())
+        {
+            tokens.append({start, text.length() - start, rule.formatName});
+            return ruleIndex + 1;
+        }
+
+        tokens.append({start, match.capturedEnd() - start, rule.formatName});
+        position = qMax(start + 1, static_cast<int>(match.capturedEnd()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+// Qt
+#include <QFuture>
+#include <QObject> // Required for inheritance
+#include <QPair>
+#include <QRegularExpression>
+#include <QVector>
+
+#include <atomic>
+
+class QTextDocument;
+class QUndoHistory;
+
+/**
+ * @brief Class, that finds all matches of a regular expression
+ * in a document. The text is scanned on the global thread pool,
+ * matches are streamed back in batches and kept up to date while
+ * the document is edited.
+ */
+class QSearchEngine : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Struct, that describes a match in the document.
+     */
+    struct Match
+    {
+        int start;
+        int length;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param history Undo history of the document to search in.
+     * Replacements are reported to it.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QSearchEngine(QUndoHistory *history, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Waits for running scans to stop.
+     */
+    ~QSearchEngine() override;
+
+    // Disable copying
+    QSearchEngine(const QSearchEngine &) = delete;
+    QSearchEngine &operator=(const QSearchEngine &) = delete;
+
+    /**
+     * @brief Static method for building a pattern for plain text.
+     * @param text Text to find.
+     * @param caseSensitive Match case.
+     * @param wholeWords Match whole words only.
+     */
+    static QRegularExpression plainTextPattern(const QString &text, bool caseSensitive, bool wholeWords);
+
+    /**
+     * @brief Method for starting a search. A running search is
+     * cancelled. An empty or invalid pattern clears the matches.
+     * @param pattern Regular expression. Matches may not span
+     * several lines, since edits are rescanned line by line.
+     */
+    void setPattern(const QRegularExpression &pattern);
+
+    /**
+     * @brief Method for getting the current pattern.
+     */
+    QRegularExpression pattern() const;
+
+    /**
+     * @brief Method for getting is the initial scan running.
+     */
+    bool isSearching() const;
+
+    /**
+     * @brief Method for getting the number of matches
+     * found so far.
+     */
+    int matchCount() const;
+
+    /**
+     * @brief Method for getting all matches found so far,
+     * sorted by start.
+     */
+    QVector<Match> matches() const;
+
+    /**
+     * @brief Method for getting the matches, that overlap
+     * a range of the document.
+     * @param from Start position, inclusive.
+     * @param to End position, exclusive.
+     */
+    QVector<Match> matchesInRange(int from, int to) const;
+
+    /**
+     * @brief Method for getting the index of the first match,
+     * that ends after a position, e.g. for "3 of 42".
+     * @return Index, matchCount() if there's no such match.
+     */
+    int matchIndexAt(int position) const;
+
+    /**
+     * @brief Method for replacing all matches in a single edit
+     * block, so it's a single undo step. Waits for a running scan.
+     * @param replacement Text, that replaces each match.
+     * @return Number of replaced matches.
+     */
+    int replaceAll(const QString &replacement);
+
+    /**
+     * @brief Method for clearing the pattern and the matches.
+     */
+    void clear();
+
+  signals:
+    /**
+     * @brief Signal, the number of matches changed. It's emitted
+     * for each batch of the scan, before it's finished.
+     */
+    void matchCountChanged(int count);
+
+    /**
+     * @brief Signal, matches were added, removed or moved.
+     */
+    void matchesChanged();
+
+    /**
+     * @brief Signal, the scan of the whole document is finished.
+     */
+    void searchFinished();
+
+  private slots:
+    /**
+     * @brief Slot, that updates the matches of the changed lines
+     * and shifts the matches after them. While a scan runs, the
+     * changed lines are rescanned, once it's finished.
+     */
+    void onTextReplaced(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Struct, that describes an edit since the snapshot
+     * of the running scan.
+     */
+    struct Edit
+    {
+        int position;
+        int charsRemoved;
+        int charsAdded;
+    };
+
+    /**
+     * @brief Method for scanning a text snapshot on the thread pool.
+     */
+    void startScan();
+
+    /**
+     * @brief Method for stopping a running scan.
+     */
+    void cancelScan();
+
+    /**
+     * @brief Method for appending a batch of a scan, unless it
+     * belongs to a cancelled one.
+     */
+    void appendMatches(int generation, const QVector<Match> &batch, bool last);
+
+    /**
+     * @brief Method for removing the matches, that overlap a range
+     * of the text before an edit, and moving the ones after it.
+     * @param from Start of the range.
+     * @param to End of the range, inclusive.
+     * @param delta Length, that the edit added.
+     * @return Index, that the matches of the range are inserted at.
+     */
+    int removeMatches(int from, int to, int delta);
+
+    /**
+     * @brief Method for scanning the whole lines of a range and
+     * inserting their matches in place of the old ones.
+     * @param from Start of the range.
+     * @param to End of the range, inclusive.
+     */
+    void rescanLines(int from, int to);
+
+    QUndoHistory *m_history;
+    QTextDocument *m_document;
+    QRegularExpression m_pattern;
+    QVector<Match> m_matches;
+    QVector<QFuture<void>> m_scans;
+    std::atomic<int> m_generation;
+
+    // Edits since the snapshot of the running scan, and the ranges of the text, they changed
+    QVector<Edit> m_scanEdits;
+    QVector<QPair<int, int>> m_changedRanges;
+
+    bool m_searching;
+    bool m_replacing;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+// Qt
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Class, that describes a snippet in the syntax of
+ * LSP snippets: $1 and ${1} are tab stops, ${1:text} is a
+ * placeholder, ${1|one,two|} is a choice and $0 is the final
+ * cursor position. Tab stops with the same number are linked,
+ * typing into one changes all of them. \$, \} and \\ escape.
+ */
+class QSnippet
+{
+  public:
+    /**
+     * @brief Struct, that describes a tab stop in the
+     * expanded text.
+     */
+    struct Field
+    {
+        /**
+         * @brief Number of the tab stop, 0 is the final one.
+         */
+        int number;
+
+        int start;
+        int length;
+
+        /**
+         * @brief Choices of the tab stop. May be empty.
+         */
+        QStringList choices;
+
+        /**
+         * @brief Index of the tab stop, whose placeholder
+         * contains this one, -1 if there's none.
+         */
+        int parent;
+    };
+
+    /**
+     * @brief Constructor of an empty snippet.
+     */
+    QSnippet();
+
+    /**
+     * @brief Constructor.
+     * @param source Snippet in LSP syntax.
+     * @param label Text, that is shown in the completion
+     * popup. Empty means the expanded text.
+     */
+    explicit QSnippet(const QString &source, const QString &label = QString());
+
+    /**
+     * @brief Method for getting is the snippet empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Method for getting the label.
+     */
+    QString label() const;
+
+    /**
+     * @brief Method for getting the snippet in LSP syntax.
+     */
+    QString source() const;
+
+    /**
+     * @brief Method for getting the expanded text, with
+     * placeholders and the first choices filled in.
+     */
+    QString text() const;
+
+    /**
+     * @brief Method for getting the tab stops, sorted by
+     * start. Nested tab stops follow the one around them.
+     */
+    QVector<Field> fields() const;
+
+    /**
+     * @brief Method for getting a copy, whose lines after
+     * the first one start with an indentation.
+     */
+    QSnippet indented(const QString &indentation) const;
+
+  private:
+    struct Node
+    {
+        QString text;
+        int number = -1;
+        bool hasPlaceholder = false;
+        QVector<Node> children;
+        QStringList choices;
+    };
+
+    /**
+     * @brief Method for parsing nodes until the end of
+     * the source or until a closing brace.
+     */
+    QVector<Node> parse(int &position, bool nested) const;
+
+    /**
+     * @brief Method for appending the expanded text and
+     * the tab stops of nodes.
+     * @param placeholders Node, that defines the text of
+     * each tab stop number.
+     * @param expanding Numbers, that are being expanded,
+     * so a tab stop inside its own placeholder stays empty.
+     * @param parent Index of the tab stop around the nodes.
+     */
+    void expand(const QVector<Node> &nodes, const QMap<int, const Node *> &placeholders, QVector<int> &expanding,
+                int parent);
+
+    QString m_source;
+    QString m_label;
+    QString m_text;
+    QVector<Field> m_fields;
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+// QCodeEditor
+#include <internal/QSnippet.hpp>
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+class QTextCursor;
+class QTextDocument;
+class QUndoHistory;
+
+/**
+ * @brief Class, that tracks the tab stops of an expanded
+ * snippet while the document is edited. The ranges of the
+ * tab stops shift with edits, the current one grows while
+ * it's typed into, and its linked tab stops are updated in
+ * the same undo step. Typing, that the editor passes to
+ * replaceLinked(), changes them in the same edit.
+ */
+class QSnippetSession : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param history Undo history of the document, the snippets
+     * are expanded in. The edits of linked tab stops are reported
+     * to it.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QSnippetSession(QUndoHistory *history, QObject *parent = nullptr);
+
+    // Disable copying
+    QSnippetSession(const QSnippetSession &) = delete;
+    QSnippetSession &operator=(const QSnippetSession &) = delete;
+
+    /**
+     * @brief Method for starting a session for a snippet,
+     * whose text was inserted. The first tab stop is current.
+     * @param snippet Snippet.
+     * @param position Position, the text was inserted at.
+     * @return Are there tab stops to visit.
+     */
+    bool start(const QSnippet &snippet, int position);
+
+    /**
+     * @brief Method for ending the session.
+     */
+    void stop();
+
+    /**
+     * @brief Method for getting is a session running.
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Method for moving to the next tab stop.
+     * @return False, if the current one was the last one.
+     */
+    bool next();
+
+    /**
+     * @brief Method for moving to the previous tab stop.
+     * @return False, if the current one was the first one.
+     */
+    bool previous();
+
+    /**
+     * @brief Method for getting the range of the current
+     * tab stop.
+     * @return Start and end position.
+     */
+    QPair<int, int> currentRange() const;
+
+    /**
+     * @brief Method for getting the choices of the current
+     * tab stop. May be empty.
+     */
+    QStringList currentChoices() const;
+
+    /**
+     * @brief Method for getting the position of the
+     * final tab stop, or the end of the snippet.
+     */
+    int finalPosition() const;
+
+    /**
+     * @brief Method for getting is a position inside
+     * the snippet.
+     */
+    bool contains(int position) const;
+
+    /**
+     * @brief Method for replacing the selection of a cursor in
+     * the current tab stop, and the tab stops linked to it, in
+     * one edit.
+     * @param cursor Cursor. It's moved after the inserted text.
+     * @param text Inserted text.
+     * @return False, if the current tab stop isn't linked or
+     * the selection isn't inside it. Nothing is changed then.
+     */
+    bool replaceLinked(QTextCursor &cursor, const QString &text);
+
+  private slots:
+    /**
+     * @brief Slot, that shifts the tab stops by a replaced
+     * text. Edits inside a tab stop let it grow, edits across
+     * its bounds end the session.
+     */
+    void onTextReplaced(int position, int charsRemoved, int charsAdded);
+
+  private:
+    struct Field
+    {
+        /**
+         * @brief Number of the tab stop, -1 for the range
+         * of the whole snippet.
+         */
+        int number;
+
+        int start;
+        int end;
+        QStringList choices;
+
+        /**
+         * @brief Index of the field around this one, -1
+         * for the whole snippet.
+         */
+        int parent;
+    };
+
+    /**
+     * @brief Method for getting the innermost tab stop,
+     * that an edit is typed into.
+     * @return Index of the field, -1 if there's none.
+     */
+    int editedField(int position, int end) const;
+
+    /**
+     * @brief Method for shifting the fields by an edit.
+     * @param grown Field, that the edit was typed into. It
+     * and the fields around it grow.
+     * @return False, if the edit crossed the bounds of a field.
+     */
+    bool shift(int position, int charsRemoved, int charsAdded, int grown);
+
+    /**
+     * @brief Method for copying the text of a field to the
+     * fields linked to it, joined to the last undo step.
+     */
+    void updateLinkedFields(int field);
+
+    /**
+     * @brief Method for copying the text of a field to the
+     * fields linked to it within the current edit block.
+     * @return False, if the session was stopped.
+     */
+    bool copyToLinkedFields(int field);
+
+    QUndoHistory *m_history;
+    QTextDocument *m_document;
+    QVector<Field> m_fields;
+    QVector<int> m_numbers;
+    int m_current;
+    bool m_active;
+    bool m_updatingLinkedFields;
+    int m_pendingLinkedField;
+};
@@ -1,9 +1,18 @@
 #pragma once
 
+// QCodeEditor
+#include <internal/QHighlightToken.hpp>
+
 // Qt
+#include <QPair>
+#include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QSyntaxHighlighter> // Required for inheritance
+#include <QVector>
 
+class QCodeBlockData;
+class QIndentationEngine;
 class QSyntaxStyle;
 class QTextDocument;
 
@@ -16,6 +25,47 @@ class QStyleSyntaxHighlighter : public QSyntaxHighlighter
     Q_OBJECT
 
   public:
+    /**
+     * @brief Enum, that describes how regions of
+     * code are found for folding.
+     */
+    enum class FoldingStyle
+    {
+        /**
+         * @brief A region spans from an opening bracket
+         * to the line of its closing one.
+         */
+        Brackets,
+
+        /**
+         * @brief A region spans the following lines,
+         * that are indented deeper.
+         */
+        Indentation
+    };
+
+    /**
+     * @brief Struct, that describes one edit of the
+     * semantic token array, like LSP SemanticTokensEdit.
+     */
+    struct SemanticTokensEdit
+    {
+        /**
+         * @brief Index in the integer array the edit starts at.
+         */
+        int start;
+
+        /**
+         * @brief Number of integers to remove.
+         */
+        int deleteCount;
+
+        /**
+         * @brief Integers to insert.
+         */
+        QVector<quint32> data;
+    };
+
     /**
      * @brief Constructor.
      * @param document Pointer to text document.
@@ -80,9 +130,183 @@ class QStyleSyntaxHighlighter : public QSyntaxHighlighter
      */
     void setEndCommentBlockSequence(const QString &endCommentBlockSequence);
 
+    /**
+     * @brief Method for tokenizing one block of text.
+     * It must not touch the document, so it can be
+     * called from any thread.
+     * @param text Text of the block.
+     * @param previousState State of the previous block, -1 for the first one.
+     * @param tokens Produced tokens. Later tokens override earlier ones.
+     * @return State of this block.
+     * @details Default implementation produces no tokens. Highlighters that
+     * override highlightBlock() instead don't take part in parallel highlighting.
+     */
+    virtual int tokenizeBlock(const QString &text, int previousState, QVector<QHighlightToken> &tokens) const;
+
+    /**
+     * @brief Method for highlighting the whole document on the
+     * global thread pool. The document is split into chunks, which
+     * are tokenized in parallel with a speculated entry state. Chunks
+     * whose speculation was wrong are re-tokenized until their states
+     * converge again. Formats are applied on the calling thread.
+     */
+    void rehighlightParallel();
+
+    /**
+     * @brief Static method for resolving overlapping tokens into
+     * sorted, non overlapping spans. Where tokens overlap, the later
+     * one wins, the same way formats are applied.
+     * @param tokens Tokens as produced by tokenizeBlock().
+     * @param length Length of the tokenized text.
+     * @return Non overlapping tokens, sorted by start.
+     */
+    static QVector<QHighlightToken> resolveTokens(const QVector<QHighlightToken> &tokens, int length);
+
+    /**
+     * @brief Method for setting the semantic token legend.
+     * @param formatNames Syntax style format names, indexed by
+     * the token type of the semantic tokens.
+     */
+    void setSemanticTokenLegend(const QStringList &formatNames);
+
+    /**
+     * @brief Method for setting semantic tokens, that are merged
+     * on top of the lexical highlighting.
+     * @param data Delta encoded integer array, like the data of LSP
+     * semanticTokens/full: groups of deltaLine, deltaStartChar, length,
+     * tokenType and tokenModifiers. Modifiers are ignored.
+     * @details Only blocks whose semantic tokens changed are rehighlighted.
+     * Tokens beyond the last line of the document are dropped.
+     */
+    void setSemanticTokens(const QVector<quint32> &data);
+
+    /**
+     * @brief Method for setting the semantic token legend and
+     * the semantic tokens together, so they're decoded once.
+     * @param formatNames Syntax style format names, indexed by
+     * the token type of the semantic tokens.
+     * @param data Delta encoded integer array, like the data of LSP
+     * semanticTokens/full.
+     */
+    void setSemanticTokens(const QStringList &formatNames, const QVector<quint32> &data);
+
+    /**
+     * @brief Method for applying edits to the semantic token array,
+     * like the edits of LSP semanticTokens/full/delta.
+     * @param edits Edits, relative to the current array.
+     */
+    void applySemanticTokensEdits(const QVector<SemanticTokensEdit> &edits);
+
+    /**
+     * @brief Method for removing all semantic tokens.
+     */
+    void clearSemanticTokens();
+
+    /**
+     * @brief Method for setting the bracket pairs, that are
+     * recorded in the block data. Takes effect for blocks,
+     * that are highlighted afterwards.
+     * @param pairs Opening and closing characters.
+     */
+    void setBracketPairs(const QVector<QPair<QChar, QChar>> &pairs);
+
+    /**
+     * @brief Method for getting the bracket pairs.
+     */
+    QVector<QPair<QChar, QChar>> bracketPairs() const;
+
+    /**
+     * @brief Method for setting the formats, whose tokens
+     * aren't code, like strings and comments. Brackets in
+     * them aren't matched and don't nest lines. Takes effect
+     * for blocks, that are highlighted afterwards.
+     * @param formatNames Syntax style format names. Default
+     * is String and Comment.
+     */
+    void setNonCodeFormats(const QStringList &formatNames);
+
+    /**
+     * @brief Method for getting the formats, whose tokens
+     * aren't code.
+     */
+    QStringList nonCodeFormats() const;
+
+    /**
+     * @brief Method for setting how foldable regions
+     * are found.
+     * @param style Folding style. Default is Brackets.
+     */
+    void setFoldingStyle(FoldingStyle style);
+
+    /**
+     * @brief Method for getting the folding style.
+     */
+    FoldingStyle foldingStyle() const;
+
+    /**
+     * @brief Method for setting the engine, that computes
+     * the indentation of lines in the editor.
+     * @param engine Indentation engine. Default nests lines
+     * by brackets.
+     */
+    void setIndentationEngine(const QSharedPointer<QIndentationEngine> &engine);
+
+    /**
+     * @brief Method for getting the indentation engine.
+     * @return Pointer to engine. May be nullptr.
+     */
+    QSharedPointer<QIndentationEngine> indentationEngine() const;
+
+  protected:
+    /**
+     * @brief Method, that tokenizes the block with tokenizeBlock()
+     * and applies the formats of the produced tokens.
+     */
+    void highlightBlock(const QString &text) override;
+
+    /**
+     * @brief Method for applying formats of tokens to the current block.
+     * @param tokens Tokens, applied in order.
+     */
+    void applyTokens(const QVector<QHighlightToken> &tokens);
+
   private:
+    struct PrecomputedBlock
+    {
+        int previousState = -1;
+        int state = 0;
+        int length = 0;
+        QVector<QHighlightToken> tokens;
+    };
+
     QSyntaxStyle *m_syntaxStyle;
 
+    /**
+     * @brief Method for decoding the semantic token array
+     * and rehighlighting the blocks that changed.
+     */
+    void updateSemanticTokens();
+
+    /**
+     * @brief Method for recording the brackets of the current
+     * block, that aren't covered by tokens, that aren't code.
+     */
+    void updateBrackets(QCodeBlockData *data, const QString &text) const;
+
+    QVector<PrecomputedBlock> m_precomputedBlocks;
+
+    QStringList m_semanticTokenLegend;
+    QVector<quint32> m_semanticTokenData;
+    QVector<QVector<QHighlightToken>> m_semanticTokens;
+
+    QVector<QPair<QChar, QChar>> m_bracketPairs;
+
+    QStringList m_nonCodeFormats;
+
+    FoldingStyle m_foldingStyle;
+
+    QSharedPointer<QIndentationEngine> m_indentationEngine;
+
   protected:
     QString m_commentLineSequence;
     QString m_startCommentBlockSequence;
@@ -0,0 +1,146 @@
+#pragma once
+
+// Qt
+#include <QMap>
+#include <QObject> // Required for inheritance
+
+#include <functional>
+
+class QTimer;
+
+/**
+ * @brief Class, that runs scheduled tasks of a widget by
+ * priority. Deferred and idle tasks run at most once per event
+ * loop pass, no matter how often they were scheduled.
+ */
+class QTaskScheduler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Enum, that describes when a task runs.
+     */
+    enum class Priority
+    {
+        /**
+         * @brief Right away, when it's scheduled, e.g. the caret
+         * and the current line. A critical task, that is scheduled
+         * while critical tasks run, runs after them.
+         */
+        Critical,
+
+        /**
+         * @brief In the next event loop pass, once the pending
+         * events were handled, e.g. after the highlighter.
+         */
+        Deferred,
+
+        /**
+         * @brief After the idle interval passed without input,
+         * one task per event loop pass. New input postpones them.
+         */
+        Idle
+    };
+
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QTaskScheduler(QObject *parent = nullptr);
+
+    // Disable copying
+    QTaskScheduler(const QTaskScheduler &) = delete;
+    QTaskScheduler &operator=(const QTaskScheduler &) = delete;
+
+    /**
+     * @brief Method for adding a task. Tasks of the same
+     * priority run in the order of their ids.
+     * @param task Id of the task, an existing task is replaced.
+     * @param priority Priority.
+     * @param function Work of the task.
+     */
+    void addTask(int task, Priority priority, std::function<void()> function);
+
+    /**
+     * @brief Method for scheduling a task. Scheduling an idle
+     * task restarts the idle interval.
+     * @param task Id of the task.
+     */
+    void schedule(int task);
+
+    /**
+     * @brief Method for unscheduling a task.
+     * @param task Id of the task.
+     */
+    void cancel(int task);
+
+    /**
+     * @brief Method for getting is a task waiting to run.
+     * @param task Id of the task.
+     */
+    bool isScheduled(int task) const;
+
+    /**
+     * @brief Method for postponing the idle tasks, when
+     * there's new input.
+     */
+    void postpone();
+
+    /**
+     * @brief Method for running all scheduled tasks now,
+     * by priority.
+     */
+    void flush();
+
+    /**
+     * @brief Method for setting the time without input,
+     * that has to pass until idle tasks run.
+     * @param msec Interval in milliseconds. Default is 100.
+     */
+    void setIdleInterval(int msec);
+
+    /**
+     * @brief Method for getting the idle interval.
+     */
+    int idleInterval() const;
+
+  private:
+    struct Task
+    {
+        Priority priority;
+        std::function<void()> function;
+        bool scheduled;
+    };
+
+    /**
+     * @brief Method for running the scheduled tasks of a
+     * priority.
+     * @param limit Maximum number of tasks to run.
+     * @return Are there scheduled tasks of the priority left.
+     */
+    bool run(Priority priority, int limit);
+
+    /**
+     * @brief Method for running the critical tasks, until
+     * none is scheduled.
+     */
+    void runCritical();
+
+    /**
+     * @brief Method for getting is a task of a priority
+     * waiting to run.
+     */
+    bool hasScheduled(Priority priority) const;
+
+    /**
+     * @brief Method for running the next idle task.
+     */
+    void runIdle();
+
+    QMap<int, Task> m_tasks;
+    bool m_runningCritical;
+    QTimer *m_deferredTimer;
+    QTimer *m_idleTimer;
+    int m_idleInterval;
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+// Qt
+#include <QByteArray>
+#include <QObject> // Required for inheritance
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief Class, that keeps the undo history of a document in
+ * place of QTextDocument's own, once it's enabled. Only the text,
+ * that an edit replaced, is kept, consecutive typing is coalesced
+ * into word sized steps, older steps are compressed and the oldest
+ * ones are dropped, once the history outgrows its memory limit.
+ * Enabled or not, it reports the text, that edits replaced.
+ */
+class QUndoHistory : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor. The history is disabled.
+     * @param document Document, whose edits are recorded.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QUndoHistory(QTextDocument *document, QObject *parent = nullptr);
+
+    // Disable copying
+    QUndoHistory(const QUndoHistory &) = delete;
+    QUndoHistory &operator=(const QUndoHistory &) = delete;
+
+    /**
+     * @brief Method for setting are edits recorded. The undo
+     * stack of the document is disabled, while they are. Either
+     * way, the steps so far are removed.
+     * @param enabled Record edits.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Method for getting are edits recorded.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Method for reverting the last step.
+     * @return Position after the reverted text, -1 if there
+     * was no step to undo.
+     */
+    int undo();
+
+    /**
+     * @brief Method for applying the last reverted step again.
+     * @return Position after the applied text, -1 if there
+     * was no step to redo.
+     */
+    int redo();
+
+    /**
+     * @brief Method for getting is there a step to undo.
+     */
+    bool isUndoAvailable() const;
+
+    /**
+     * @brief Method for getting is there a step to redo.
+     */
+    bool isRedoAvailable() const;
+
+    /**
+     * @brief Method for ending the current step, so the next
+     * edit starts a new one. Until then, all edits of an event
+     * loop pass, e.g. a key press and the indentation it causes,
+     * are one step.
+     */
+    void closeStep();
+
+    /**
+     * @brief Method for removing all steps.
+     */
+    void clear();
+
+    /**
+     * @brief Method for setting the memory, that the steps may
+     * take. The oldest steps are dropped beyond it, the last
+     * one is always kept.
+     * @param bytes Limit in bytes. Default is 32 MiB.
+     */
+    void setMemoryLimit(qint64 bytes);
+
+    /**
+     * @brief Method for getting the memory limit.
+     */
+    qint64 memoryLimit() const;
+
+    /**
+     * @brief Method for getting the approximate memory, that
+     * the undo and redo steps and the copy of the text, that
+     * removed text is taken from, take. Only the steps count
+     * towards the memory limit.
+     * @return Bytes.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Method for reporting an edit inside an edit block.
+     * QTextDocument reports the edits of an edit block as one
+     * range, from the first edit to the last, once it ends. If
+     * every edit of the block is reported here, each one is
+     * recorded on its own and that range is skipped. Outside of
+     * an edit block the report is ignored.
+     * @param position Start of the edit.
+     * @param charsRemoved Length of the replaced text. The range
+     * may be wider than the edit, it's narrowed to the text, that
+     * differs.
+     * @param charsAdded Length of the inserted text.
+     */
+    void reportEdit(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for getting the document, whose edits are
+     * recorded.
+     */
+    QTextDocument *document() const;
+
+  signals:
+    /**
+     * @brief Signal, that is emitted when undo becomes
+     * available or unavailable.
+     */
+    void undoAvailable(bool available);
+
+    /**
+     * @brief Signal, that is emitted when redo becomes
+     * available or unavailable.
+     */
+    void redoAvailable(bool available);
+
+    /**
+     * @brief Signal, that is emitted when an edit changed the
+     * text, also while a step is undone or redone. Format changes,
+     * that QTextDocument reports as edits of the same text, aren't,
+     * and the range is narrowed to the text, that differs.
+     */
+    void textReplaced(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Struct, that describes one replacement of text.
+     */
+    struct Change
+    {
+        int position;
+        QString removed;
+        QString inserted;
+    };
+
+    /**
+     * @brief Struct, that describes one undo step. Steps,
+     * that were compressed, keep their changes in compressed
+     * instead.
+     */
+    struct Step
+    {
+        QVector<Change> changes;
+        QByteArray compressed;
+        bool typing;
+    };
+
+    /**
+     * @brief Method for recording an edit of the document,
+     * unless its edits were reported one by one.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for recording a replacement of text.
+     * @return False, if the text didn't change.
+     */
+    bool replace(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Method for taking the copy of the text from
+     * the document.
+     */
+    void readText();
+
+    /**
+     * @brief Method for recording a change as a new step,
+     * or as part of the current one.
+     */
+    void record(const Change &change);
+
+    /**
+     * @brief Method for keeping the last step open for the
+     * edits of this event loop pass.
+     */
+    void openStep();
+
+    /**
+     * @brief Method for coalescing a typed or deleted character
+     * into the last step.
+     * @return False, if the change doesn't continue the word,
+     * that was typed or deleted last.
+     */
+    bool coalesce(const Change &change);
+
+    /**
+     * @brief Method for applying the changes of a step, or
+     * reverting them.
+     * @return Position after the last applied text.
+     */
+    int apply(const Step &step, bool revert);
+
+    /**
+     * @brief Method for compressing the steps, that are far
+     * from the newest one, and dropping the oldest steps,
+     * while the memory limit is exceeded.
+     */
+    void compact();
+
+    /**
+     * @brief Method for compressing the changes of a step.
+     */
+    void compress(Step &step);
+
+    /**
+     * @brief Method for getting the changes of a step. Changes
+     * of a compressed step are decompressed, the step stays
+     * compressed.
+     */
+    QVector<Change> changes(const Step &step) const;
+
+    /**
+     * @brief Method for getting a range of the copy of the text.
+     */
+    QString textAt(int position, int length) const;
+
+    /**
+     * @brief Method for replacing a range of the copy of the
+     * text. Only the chunks of the range are changed.
+     */
+    void replaceText(int position, int length, const QString &text);
+
+    /**
+     * @brief Method for updating the memory usage, before and
+     * after a step is modified.
+     */
+    void account(const Step &step, int sign);
+
+    /**
+     * @brief Method for emitting the availability signals
+     * after the steps changed.
+     */
+    void updateAvailability();
+
+    QTextDocument *m_document;
+    bool m_enabled;
+
+    // Text of the document in chunks, the removed text of an edit is taken from
+    QVector<QString> m_text;
+    int m_textLength;
+
+    // Undo steps, followed by the redo steps from m_index on
+    QVector<Step> m_steps;
+    int m_index;
+
+    // Index, at which the document was saved, -1 if it can't be reached again
+    int m_cleanIndex;
+
+    // Steps before this one were already looked at for compression
+    int m_compacted;
+
+    qint64 m_memoryLimit;
+    qint64 m_memoryUsage;
+    bool m_stepOpen;
+    int m_closeGeneration;
+    bool m_applying;
+
+    // The edits of the current edit block were reported, the range, that the document reports, is skipped
+    bool m_editBlockReported;
+
+    bool m_undoAvailable;
+    bool m_redoAvailable;
+};
@@ -1,20 +1,56 @@
 #pragma once
 
 // QCodeEditor
-#include <internal/QStyleSyntaxHighlighter.hpp> // Required for inheritance
-
-// Qt
-#include <QRegularExpression>
-#include <QVector>
+#include <internal/QRuleHighlighter.hpp> // Required for inheritance
 
 class QTextDocument;
-class QTextCharFormat;
+
+/**
+ * @brief Compile time rule tables of the XML highlighter.
+ */
+struct QXMLLanguagePolicy
+{
+    static constexpr const char *languageFile = nullptr;
+    static constexpr const char *keywordPattern = nullptr;
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> preRules = {};
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> rules = {
+        // Elements
+        {R"(<[\s]*[/]?[\s]*([^\n][a-zA-Z-_:]*)(?=[\s/>]))", "Keyword"},
+        // Keywords, after elements to fix any occasional / captured into the enclosing element
+        {R"(<\?)", "Keyword"},
+        {R"(/>)", "Keyword"},
+        {R"(>)", "Keyword"},
+        {R"(<)", "Keyword"},
+        {R"(</)", "Keyword"},
+        {R"(\?>)", "Keyword"},
+        // Attributes
+        {R"(\w+(?=\=))", "Text"},
+    };
+
+    static constexpr std::initializer_list<QHighlightBlockRuleDefinition> blockRules = {
+        // Comments
+        {R"(<!--)", R"(-->)", "Comment"},
+    };
+
+    static constexpr std::initializer_list<QHighlightRuleDefinition> postRules = {
+        // Values
+        {R"("[^\n"]+"(?=\??[\s/>]))", "String"},
+    };
+
+    static constexpr const char *commentLine = "";
+    static constexpr const char *commentBlockStart = "<!--";
+    static constexpr const char *commentBlockEnd = "-->";
+    static constexpr auto folding = QStyleSyntaxHighlighter::FoldingStyle::Brackets;
+    using indentation = QIndentationEngine;
+};
 
 /**
  * @brief Class, that describes XML code
  * highlighter.
  */
-class QXMLHighlighter : public QStyleSyntaxHighlighter
+class QXMLHighlighter : public QRuleHighlighter<QXMLLanguagePolicy>
 {
     Q_OBJECT
   public:
@@ -23,17 +59,4 @@ class QXMLHighlighter : public QStyleSyntaxHighlighter
      * @param document Pointer to document.
      */
     explicit QXMLHighlighter(QTextDocument *document = nullptr);
-
-  protected:
-    void highlightBlock(const QString &text) override;
-
-  private:
-    void highlightByRegex(const QTextCharFormat &format, const QRegularExpression &regex, const QString &text);
-
-    QVector<QRegularExpression> m_xmlKeywordRegexes;
-    QRegularExpression m_xmlElementRegex;
-    QRegularExpression m_xmlAttributeRegex;
-    QRegularExpression m_xmlValueRegex;
-    QRegularExpression m_xmlCommentBeginRegex;
-    QRegularExpression m_xmlCommentEndRegex;
 };
@@ -0,0 +1,407 @@
+// QCodeEditor
+#include <internal/QBracketIndex.hpp>
+#include <internal/QCodeBlockData.hpp>
+
+// Qt
+#include <QTextDocument>
+
+#include <algorithm>
+
+// Blocks per chunk. A chunk is split at twice this size and merged with the next one at half of it.
+static const int CHUNK_SIZE = 256;
+
+QBracketIndex::QBracketIndex(QTextDocument *document)
+    : QObject(document), m_document(document), m_chunks(), m_blockCount(0), m_pending()
+{
+    connect(m_document, &QTextDocument::contentsChange, this, &QBracketIndex::onContentsChange);
+    reset();
+}
+
+QBracketIndex *QBracketIndex::get(const QTextDocument *document)
+{
+    if (document == nullptr)
+    {
+        return nullptr;
+    }
+
+    return document->findChild<QBracketIndex *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+void QBracketIndex::invalidate(const QTextBlock &block)
+{
+    auto number = block.blockNumber();
+
+    // The highlighter sees an edit before the index, its chunks are updated first
+    if (m_blockCount != m_document->blockCount())
+    {
+        m_pending.append(number);
+        return;
+    }
+
+    markChanged(number);
+}
+
+int QBracketIndex::depth(const QTextBlock &block)
+{
+    synchronize();
+
+    if (!block.isValid())
+    {
+        return 0;
+    }
+
+    auto number = block.blockNumber();
+    auto index = chunkAt(number);
+
+    // Blocks without data don't change the nesting
+    int depth = 0;
+    for (int i = 0; i < index; ++i)
+    {
+        validate(i);
+        depth += m_chunks.at(i).all.delta;
+    }
+
+    auto previous = m_document->findBlockByNumber(m_chunks.at(index).first);
+    for (; previous.isValid() && previous != block; previous = previous.next())
+    {
+        auto data = QCodeBlockData::get(previous);
+        if (data != nullptr)
+        {
+            depth += data->bracketDelta;
+        }
+    }
+
+    return depth;
+}
+
+QTextBlock QBracketIndex::findForward(QTextBlock block, QChar open, QChar close, int &depth)
+{
+    synchronize();
+
+    if (!block.isValid())
+    {
+        return block;
+    }
+
+    auto number = block.blockNumber();
+    auto skipped = false;
+
+    for (auto index = chunkAt(number); index < m_chunks.size(); ++index)
+    {
+        auto first = m_chunks.at(index).first;
+        auto end = first + m_chunks.at(index).count;
+
+        // Whole chunks are skipped, while the nesting stays above zero
+        if (number == first)
+        {
+            auto summary = chunkSummary(index, open, close);
+            if (summary != nullptr && depth + summary->minimum > 0)
+            {
+                depth += summary->delta;
+                number = end;
+                skipped = true;
+                continue;
+            }
+        }
+
+        if (skipped)
+        {
+            block = m_document->findBlockByNumber(number);
+            skipped = false;
+        }
+
+        for (; number < end; ++number, block = block.next())
+        {
+            int delta = 0;
+            int minimum = 0;
+            if (!blockSummary(block, open, close, delta, minimum) || depth + minimum <= 0)
+            {
+                return block;
+            }
+
+            depth += delta;
+        }
+    }
+
+    return QTextBlock();
+}
+
+QTextBlock QBracketIndex::findBackward(QTextBlock block, QChar open, QChar close, int &depth)
+{
+    synchronize();
+
+    if (!block.isValid())
+    {
+        return block;
+    }
+
+    auto number = block.blockNumber();
+    auto skipped = false;
+
+    for (auto index = chunkAt(number); index >= 0; --index)
+    {
+        auto first = m_chunks.at(index).first;
+        auto last = first + m_chunks.at(index).count - 1;
+
+        // Taken backwards, the lowest nesting of a range is its minimum past its change
+        if (number == last)
+        {
+            auto summary = chunkSummary(index, open, close);
+            if (summary != nullptr && depth - summary->delta + summary->minimum > 0)
+            {
+                depth -= summary->delta;
+                number = first - 1;
+                skipped = true;
+                continue;
+            }
+        }
+
+        if (skipped)
+        {
+            block = m_document->findBlockByNumber(number);
+            skipped = false;
+        }
+
+        for (; number >= first; --number, block = block.previous())
+        {
+            int delta = 0;
+            int minimum = 0;
+            if (!blockSummary(block, open, close, delta, minimum) || depth - delta + minimum <= 0)
+            {
+                return block;
+            }
+
+            depth -= delta;
+        }
+    }
+
+    return QTextBlock();
+}
+
+void QBracketIndex::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    // Edits within blocks are reported by the highlighter, once their brackets changed
+    auto delta = m_document->blockCount() - m_blockCount;
+    if (delta == 0)
+    {
+        return;
+    }
+
+    auto lastPosition = m_document->characterCount() - 1;
+    auto firstBlock = m_document->findBlock(qBound(0, position, lastPosition));
+    auto lastBlock = m_document->findBlock(qBound(0, position + charsAdded, lastPosition));
+    int firstLine = firstBlock.blockNumber();
+    int newCount = lastBlock.blockNumber() - firstLine + 1;
+    int oldCount = newCount - delta;
+
+    if (oldCount < 1 || firstLine + oldCount > m_blockCount)
+    {
+        reset();
+        return;
+    }
+
+    // Removed blocks are taken from the chunks they were in, the ones they emptied are dropped
+    auto index = chunkAt(firstLine);
+    auto remaining = oldCount;
+    auto current = index;
+    auto start = firstLine - m_chunks.at(index).first;
+    while (remaining > 0)
+    {
+        auto &chunk = m_chunks[current];
+        auto count = qMin(remaining, chunk.count - start);
+        chunk.count -= count;
+        chunk.valid = false;
+        remaining -= count;
+        ++current;
+        start = 0;
+    }
+
+    for (int i = current - 1; i > index; --i)
+    {
+        if (m_chunks.at(i).count == 0)
+        {
+            m_chunks.remove(i);
+        }
+    }
+
+    // Added blocks go to the chunk of the first one, that is kept near its size
+    m_chunks[index].count += newCount;
+    m_blockCount += delta;
+
+    if (m_chunks.at(index).count < CHUNK_SIZE / 2 && index + 1 < m_chunks.size())
+    {
+        m_chunks[index].count += m_chunks.at(index + 1).count;
+        m_chunks.remove(index + 1);
+    }
+
+    while (m_chunks.at(index).count > 2 * CHUNK_SIZE)
+    {
+        m_chunks[index].count -= CHUNK_SIZE;
+        m_chunks.insert(index + 1, Chunk{0, CHUNK_SIZE, false, Summary(), QVector<Summary>()});
+    }
+
+    renumber(index);
+
+    for (auto &&number : m_pending)
+    {
+        markChanged(number);
+    }
+
+    m_pending.clear();
+}
+
+bool QBracketIndex::blockSummary(const QTextBlock &block, QChar open, QChar close, int &delta, int &minimum)
+{
+    auto data = QCodeBlockData::get(block);
+    if (data == nullptr)
+    {
+        return false;
+    }
+
+    // Closing brackets of all pairs are taken as if they came first
+    if (open.isNull())
+    {
+        delta = data->bracketDelta;
+        minimum = 0;
+        for (auto &&summary : data->bracketSummaries)
+        {
+            minimum -= summary.unmatchedCloses;
+        }
+
+        return true;
+    }
+
+    auto summary = data->bracketSummary(open, close);
+    if (summary == nullptr)
+    {
+        return false;
+    }
+
+    delta = summary->unmatchedOpens - summary->unmatchedCloses;
+    minimum = -summary->unmatchedCloses;
+    return true;
+}
+
+const QBracketIndex::Summary *QBracketIndex::chunkSummary(int index, QChar open, QChar close)
+{
+    validate(index);
+
+    auto &chunk = m_chunks[index];
+    if (open.isNull())
+    {
+        return chunk.all.complete ? &chunk.all : nullptr;
+    }
+
+    for (auto &&summary : chunk.pairs)
+    {
+        if (summary.open == open && summary.close == close)
+        {
+            return summary.complete ? &summary : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+void QBracketIndex::validate(int index)
+{
+    auto &chunk = m_chunks[index];
+    if (!chunk.valid)
+    {
+        summarize(chunk);
+        chunk.valid = true;
+    }
+}
+
+void QBracketIndex::summarize(Chunk &chunk) const
+{
+    chunk.all = {QChar(), QChar(), 0, 0, true};
+    chunk.pairs.clear();
+
+    auto block = m_document->findBlockByNumber(chunk.first);
+
+    auto add = [&block](Summary &summary) {
+        int delta = 0;
+        int minimum = 0;
+        if (!blockSummary(block, summary.open, summary.close, delta, minimum))
+        {
+            summary.complete = false;
+            return;
+        }
+
+        summary.minimum = qMin(summary.minimum, summary.delta + minimum);
+        summary.delta += delta;
+    };
+
+    for (int i = 0; i < chunk.count && block.isValid(); ++i, block = block.next())
+    {
+        // Pairs are taken from the first block, a pair, that another block lacks, is incomplete
+        auto data = QCodeBlockData::get(block);
+        if (i == 0 && data != nullptr)
+        {
+            for (auto &&summary : data->bracketSummaries)
+            {
+                chunk.pairs.append({summary.open, summary.close, 0, 0, true});
+            }
+        }
+
+        add(chunk.all);
+        for (auto &&summary : chunk.pairs)
+        {
+            add(summary);
+        }
+    }
+}
+
+int QBracketIndex::chunkAt(int number) const
+{
+    auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), number,
+                               [](int value, const Chunk &chunk) { return value < chunk.first; });
+
+    return qMax(0, static_cast<int>(it - m_chunks.cbegin()) - 1);
+}
+
+void QBracketIndex::markChanged(int number)
+{
+    if (number >= 0 && number < m_blockCount)
+    {
+        m_chunks[chunkAt(number)].valid = false;
+    }
+}
+
+void QBracketIndex::renumber(int chunk)
+{
+    int first = 0;
+    if (chunk > 0)
+    {
+        first = m_chunks.at(chunk - 1).first + m_chunks.at(chunk - 1).count;
+    }
+
+    for (int i = chunk; i < m_chunks.size(); ++i)
+    {
+        m_chunks[i].first = first;
+        first += m_chunks.at(i).count;
+    }
+}
+
+void QBracketIndex::reset()
+{
+    m_chunks.clear();
+    m_pending.clear();
+    m_blockCount = m_document->blockCount();
+
+    for (int first = 0; first < m_blockCount; first += CHUNK_SIZE)
+    {
+        m_chunks.append({first, qMin(CHUNK_SIZE, m_blockCount - first), false, Summary(), QVector<Summary>()});
+    }
+}
+
+void QBracketIndex::synchronize()
+{
+    if (m_blockCount != m_document->blockCount())
+    {
+        reset();
+    }
+}
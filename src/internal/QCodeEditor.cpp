@@ -1,35 +1,100 @@
 // QCodeEditor
+#include <internal/QBracketIndex.hpp>
+#include <internal/QCodeBlockData.hpp>
 #include <internal/QCodeEditor.hpp>
+#include <internal/QCompletionEngine.hpp>
+#include <internal/QCompletionProvider.hpp>
+#include <internal/QIdentifierIndex.hpp>
+#include <internal/QIndentationEngine.hpp>
+#include <internal/QLanguageCompleter.hpp>
 #include <internal/QLineNumberArea.hpp>
+#include <internal/QSearchEngine.hpp>
+#include <internal/QSnippetSession.hpp>
 #include <internal/QStyleSyntaxHighlighter.hpp>
 #include <internal/QSyntaxStyle.hpp>
+#include <internal/QTaskScheduler.hpp>
+#include <internal/QUndoHistory.hpp>
 
 // Qt
 #include <QAbstractItemView>
 #include <QAbstractTextDocumentLayout>
+#include <QAction>
+#include <QClipboard>
 #include <QCompleter>
+#include <QContextMenuEvent>
 #include <QCursor>
 #include <QDebug>
 #include <QFontDatabase>
+#include <QGlyphRun>
+#include <QGuiApplication>
+#include <QMenu>
 #include <QMimeData>
+#include <QPainter>
+#include <QPainterPath>
 #include <QPaintEvent>
 #include <QScrollBar>
 #include <QShortcut>
+#include <QStringListModel>
 #include <QTextCharFormat>
-#include <QTextStream>
+#include <QTextLayout>
 #include <QToolTip>
+#include <QtMath>
+
+#include <algorithm>
+#include <numeric>
 
 QRegularExpression buildLineStartIndentRegex(int tabSize)
 {
     return QRegularExpression("^(\t| {1," + QString::number(tabSize) + "})");
 }
 
+static QVector<QPair<QChar, QChar>> bracketPairsOf(const QVector<QCodeEditor::Parenthesis> &parentheses)
+{
+    QVector<QPair<QChar, QChar>> pairs;
+    for (auto &&p : parentheses)
+    {
+        // Quotes are left to the string tokens of the highlighter
+        if (p.left != p.right)
+            pairs.append({p.left, p.right});
+    }
+
+    return pairs;
+}
+
+// First index in [0, count), that isn't before, for indices, that are all before the ones, that aren't
+template <typename Before> static int firstIndex(int count, Before before)
+{
+    int first = 0;
+    while (count > 0)
+    {
+        auto half = count / 2;
+        if (before(first + half))
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
 QCodeEditor::QCodeEditor(QWidget *widget)
     : QTextEdit(widget), m_highlighter(nullptr), m_syntaxStyle(nullptr), m_lineNumberArea(new QLineNumberArea(this)),
-      m_completer(nullptr), m_autoIndentation(true), m_replaceTab(true), m_extraBottomMargin(true),
+      m_completer(nullptr), m_completionProvider(), m_completionEngine(new QCompletionEngine(this)),
+      m_completionPopup(new QCompleter(this)), m_completionModel(new QStringListModel(this)), m_autoIndentation(true),
+      m_replaceTab(true), m_extraBottomMargin(true), m_bracketPairColorization(true), m_documentWordCompletion(true),
       m_textChanged(false), m_tabReplace(4, ' '),
-      m_parentheses({{'(', ')'}, {'{', '}'}, {'[', ']'}, {'\"', '\"'}, {'\'', '\''}}),
-      m_lineStartIndentRegex(buildLineStartIndentRegex(4))
+      m_parentheses({{'(', ')'}, {'{', '}'}, {'[', ']'}, {'\"', '\"'}, {'\'', '\''}}), m_extraCursors(),
+      m_editingCursors(false), m_blockSelection(), m_hasBlockSelection(false), m_blockSelecting(false),
+      m_lineStartIndentRegex(buildLineStartIndentRegex(4)), m_lineStartCommentRegex(),
+      m_undoHistory(new QUndoHistory(document(), this)), m_wordOccurrences(new QSearchEngine(m_undoHistory, this)),
+      m_wordOccurrenceText(), m_identifierIndex(new QIdentifierIndex(document(), this)), m_folds(),
+      m_foldMaximumEnds(), m_changingVisibility(false), m_scheduler(new QTaskScheduler(this)),
+      m_snippetSession(new QSnippetSession(m_undoHistory, this))
 {
     initFont();
     performConnections();
@@ -54,16 +119,82 @@ void QCodeEditor::initFont()
 
 void QCodeEditor::performConnections()
 {
-    connect(document(), &QTextDocument::blockCountChanged, this, [this]() {
+    // The caret and the layout are updated right away. The rest of the work is coalesced over
+    // an event loop pass and waits for the highlighter or for idle time.
+    m_scheduler->addTask(CurrentLineTask, QTaskScheduler::Priority::Critical, [this] { highlightCurrentLine(); });
+    m_scheduler->addTask(LineNumberTask, QTaskScheduler::Priority::Critical, [this] {
         m_lineNumberArea->updateEditorLineCount();
         updateLineNumberMarginWidth();
     });
-    connect(document(), &QTextDocument::blockCountChanged, this, &QCodeEditor::updateBottomMargin);
+    m_scheduler->addTask(BottomMarginTask, QTaskScheduler::Priority::Critical, [this] { updateBottomMargin(); });
+    m_scheduler->addTask(ParenthesisTask, QTaskScheduler::Priority::Deferred, [this] { highlightParenthesis(); });
+    m_scheduler->addTask(WordOccurrenceTask, QTaskScheduler::Priority::Idle, [this] { highlightWordOccurrences(); });
+
+    connect(document(), &QTextDocument::blockCountChanged, this, [this] {
+        m_scheduler->schedule(LineNumberTask);
+        m_scheduler->schedule(BottomMarginTask);
+    });
 
     connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int) { m_lineNumberArea->update(); });
 
     connect(this, &QTextEdit::cursorPositionChanged, this, &QCodeEditor::updateParenthesisAndCurrentLineHighlights);
     connect(this, &QTextEdit::selectionChanged, this, &QCodeEditor::updateWordOccurrenceHighlights);
+
+    // Provided completions are already filtered, the popup shows them as they arrive
+    m_completionPopup->setWidget(this);
+    m_completionPopup->setModel(m_completionModel);
+    m_completionPopup->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_completionPopup->setWrapAround(true);
+
+    connect(m_completionPopup, QOverload<const QString &>::of(&QCompleter::activated), this,
+            &QCodeEditor::insertCompletion);
+    connect(m_completionEngine, &QCompletionEngine::completionsAdded, this, &QCodeEditor::showCompletions);
+    connect(m_completionEngine, &QCompletionEngine::finished, this, [this](int count) {
+        if (count == 0)
+            m_completionPopup->popup()->hide();
+    });
+
+    // Moving the caret out of a snippet ends it
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this] {
+        if (m_snippetSession->isActive() && !m_snippetSession->contains(textCursor().position()))
+            m_snippetSession->stop();
+    });
+
+    // While the history is enabled, the document's own undo stack is disabled and the history reports in its place
+    connect(m_undoHistory, &QUndoHistory::undoAvailable, this, &QTextEdit::undoAvailable);
+    connect(m_undoHistory, &QUndoHistory::redoAvailable, this, &QTextEdit::redoAvailable);
+
+    // The history tells real replacements from format changes, that keep the length
+    connect(m_undoHistory, &QUndoHistory::textReplaced, this, &QCodeEditor::shiftDecorations);
+
+    connect(m_wordOccurrences, &QSearchEngine::matchesChanged, viewport(), QOverload<>::of(&QWidget::update));
+    connect(m_wordOccurrences, &QSearchEngine::matchCountChanged, this, &QCodeEditor::wordOccurrenceCountChanged);
+
+    connect(document(), &QTextDocument::contentsChange, this, &QCodeEditor::shiftCursors);
+
+    // Folds are checked once the highlighter recorded the brackets of the edit
+    connect(document(), &QTextDocument::contentsChange, this, [this](int position, int charsRemoved, int charsAdded) {
+        if (m_changingVisibility)
+            return;
+
+        QMetaObject::invokeMethod(
+            this, [this, position, charsRemoved, charsAdded] { updateFolds(position, charsRemoved, charsAdded); },
+            Qt::QueuedConnection);
+    });
+
+    // A caret, that moved into a folded region, e.g. by a search, unfolds it
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this] {
+        auto line = textCursor().blockNumber();
+        if (textCursor().block().isVisible())
+            return;
+
+        for (int i = static_cast<int>(m_folds.size()) - 1; i >= 0; --i)
+        {
+            auto first = m_folds.at(i).start.blockNumber();
+            if (first < line && m_folds.at(i).end.blockNumber() >= line)
+                setFolded(first, false);
+        }
+    });
 }
 
 void QCodeEditor::setHighlighter(QStyleSyntaxHighlighter *highlighter)
@@ -78,7 +209,9 @@ void QCodeEditor::setHighlighter(QStyleSyntaxHighlighter *highlighter)
     if (m_highlighter)
     {
         m_highlighter->setSyntaxStyle(m_syntaxStyle);
+        m_highlighter->setBracketPairs(bracketPairsOf(m_parentheses));
         m_highlighter->setDocument(document());
+        m_highlighter->rehighlightParallel();
 
         auto comment = m_highlighter->commentLineSequence();
         if (comment.isEmpty())
@@ -110,7 +243,7 @@ void QCodeEditor::updateStyle()
 {
     if (m_highlighter)
     {
-        m_highlighter->rehighlight();
+        m_highlighter->rehighlightParallel();
     }
 
 #ifndef QT_NO_STYLE_STYLESHEET
@@ -216,21 +349,21 @@ void QCodeEditor::updateLineNumberArea(const QRect &rect)
 
 void QCodeEditor::updateParenthesisAndCurrentLineHighlights()
 {
-    m_parenAndCurLineHilits.clear();
-
-    highlightCurrentLine();
-    highlightParenthesis();
-
-    setExtraSelections(m_parenAndCurLineHilits + m_wordOccurHilits);
+    m_scheduler->schedule(CurrentLineTask);
+    m_scheduler->schedule(ParenthesisTask);
 }
 
 void QCodeEditor::updateWordOccurrenceHighlights()
 {
-    m_wordOccurHilits.clear();
-
-    highlightWordOccurrences();
+    // Without a selection there is nothing to search, a search for an earlier selection is dropped
+    if (!textCursor().hasSelection())
+    {
+        m_scheduler->cancel(WordOccurrenceTask);
+        highlightWordOccurrences();
+        return;
+    }
 
-    setExtraSelections(m_parenAndCurLineHilits + m_wordOccurHilits);
+    m_scheduler->schedule(WordOccurrenceTask);
 }
 
 void QCodeEditor::indent()
@@ -244,26 +377,46 @@ void QCodeEditor::unindent()
     removeInEachLineOfSelection(m_lineStartIndentRegex, true);
 }
 
+void QCodeEditor::reindent()
+{
+    auto cursor = textCursor();
+    auto firstLine = document()->findBlock(cursor.selectionStart()).blockNumber();
+    auto lastLine = document()->findBlock(cursor.selectionEnd()).blockNumber();
+
+    reindentLines(firstLine, lastLine, false);
+}
+
 void QCodeEditor::swapLineUp()
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
+    auto previousBlock = firstBlock.previous();
 
-    if (lineStart == 0)
+    if (!previousBlock.isValid())
         return;
-    selectionStart -= lines[lineStart - 1].length() + 1;
-    selectionEnd -= lines[lineStart - 1].length() + 1;
-    lines.move(lineStart - 1, lineEnd);
 
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(lines.join('\n'));
+    // Move the line above the selection below it, touching only these blocks
+    auto previousText = previousBlock.text();
+    int previousPosition = previousBlock.position();
+    int previousLength = previousBlock.length();
+    int lastBlockEnd = lastBlock.position() + lastBlock.text().length();
+
+    cursor.beginEditBlock();
+    cursor.setPosition(lastBlockEnd);
+    cursor.insertText("\n" + previousText);
+    m_undoHistory->reportEdit(lastBlockEnd, 0, previousLength);
+    cursor.setPosition(previousPosition);
+    cursor.setPosition(previousPosition + previousLength, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    m_undoHistory->reportEdit(previousPosition, previousLength, 0);
+    cursor.endEditBlock();
+
+    selectionStart -= previousLength;
+    selectionEnd -= previousLength;
 
     if (cursorAtEnd)
     {
@@ -282,23 +435,34 @@ void QCodeEditor::swapLineUp()
 void QCodeEditor::swapLineDown()
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
+    auto nextBlock = lastBlock.next();
 
-    if (lineEnd == document()->blockCount() - 1)
+    if (!nextBlock.isValid())
         return;
-    selectionStart += lines[lineEnd + 1].length() + 1;
-    selectionEnd += lines[lineEnd + 1].length() + 1;
-    lines.move(lineEnd + 1, lineStart);
 
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(lines.join('\n'));
+    // Move the line below the selection above it, touching only these blocks
+    auto nextText = nextBlock.text();
+    int nextLength = nextBlock.length();
+    int firstPosition = firstBlock.position();
+    int lastBlockEnd = lastBlock.position() + lastBlock.text().length();
+
+    cursor.beginEditBlock();
+    cursor.setPosition(lastBlockEnd);
+    cursor.setPosition(lastBlockEnd + nextLength, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    m_undoHistory->reportEdit(lastBlockEnd, nextLength, 0);
+    cursor.setPosition(firstPosition);
+    cursor.insertText(nextText + "\n");
+    m_undoHistory->reportEdit(firstPosition, 0, nextLength);
+    cursor.endEditBlock();
+
+    selectionStart += nextLength;
+    selectionEnd += nextLength;
 
     if (cursorAtEnd)
     {
@@ -438,100 +602,135 @@ void QCodeEditor::toggleBlockComment()
     setTextCursor(cursor);
 }
 
+void QCodeEditor::addNextOccurrence()
+{
+    auto cursor = textCursor();
+    if (!cursor.hasSelection())
+    {
+        cursor.select(QTextCursor::WordUnderCursor);
+        setTextCursor(cursor);
+        return;
+    }
+
+    auto text = cursor.selectedText();
+    auto found = document()->find(text, cursor.selectionEnd(), QTextDocument::FindCaseSensitively);
+    if (found.isNull())
+        found = document()->find(text, 0, QTextDocument::FindCaseSensitively);
+
+    if (found.isNull() || found.selectionStart() == cursor.selectionStart())
+        return;
+
+    for (auto &&extra : qAsConst(m_extraCursors))
+    {
+        if (extra.start() == found.selectionStart())
+            return;
+    }
+
+    // The new occurrence becomes the text cursor, so it's scrolled into view
+    m_extraCursors.append({cursor.anchor(), cursor.position()});
+    setTextCursor(found);
+    mergeCursors();
+    viewport()->update();
+}
+
+void QCodeEditor::selectAllOccurrences()
+{
+    auto cursor = textCursor();
+    if (!cursor.hasSelection())
+    {
+        cursor.select(QTextCursor::WordUnderCursor);
+        setTextCursor(cursor);
+    }
+
+    auto text = cursor.selectedText();
+    if (text.isEmpty() || text.contains(QChar::ParagraphSeparator))
+        return;
+
+    // Each search continues after the last match, so the document is scanned once without copying it
+    m_extraCursors.clear();
+    for (auto found = document()->find(text, 0, QTextDocument::FindCaseSensitively); !found.isNull();
+         found = document()->find(text, found.selectionEnd(), QTextDocument::FindCaseSensitively))
+    {
+        if (found.selectionStart() != cursor.selectionStart())
+            m_extraCursors.append({found.selectionStart(), found.selectionEnd()});
+    }
+
+    mergeCursors();
+    viewport()->update();
+}
+
 void QCodeEditor::highlightParenthesis()
 {
+    auto position = textCursor().position();
     auto currentSymbol = charUnderCursor();
     auto prevSymbol = charUnderCursor(-1);
 
+    QVector<Decoration> decorations;
+    m_parenthesisHilits.clear();
+
     for (auto &p : m_parentheses)
     {
-        int direction;
-
-        QChar counterSymbol;
-        QChar activeSymbol;
-        auto position = textCursor().position();
+        int bracket;
 
         if (p.left == currentSymbol)
         {
-            direction = 1;
-            counterSymbol = p.right;
-            activeSymbol = currentSymbol;
+            bracket = position;
         }
         else if (p.right == prevSymbol)
         {
-            direction = -1;
-            counterSymbol = p.left;
-            activeSymbol = prevSymbol;
-            position--;
+            bracket = position - 1;
         }
         else
         {
             continue;
         }
 
-        auto counter = 1;
+        auto match = matchingParenthesis(bracket);
 
-        while (counter != 0 && position > 0 && position < (document()->characterCount() - 1))
+        // Found
+        if (match >= 0)
         {
-            // Moving position
-            position += direction;
+            auto format = m_syntaxStyle->getFormat("Parentheses");
+            decorations.append({match, match + 1, format});
+            decorations.append({bracket, bracket + 1, format});
 
-            auto character = document()->characterAt(position);
-            // Checking symbol under position
-            if (character == activeSymbol)
-            {
-                ++counter;
-            }
-            else if (character == counterSymbol)
+            // Text is drawn by the layout, so the foreground goes on top of the bracket colors
+            if (format.hasProperty(QTextFormat::ForegroundBrush))
             {
-                --counter;
+                for (auto at : {bracket, match})
+                {
+                    ExtraSelection selection{};
+                    selection.format.setForeground(format.foreground());
+                    selection.cursor = QTextCursor(document());
+                    selection.cursor.setPosition(at);
+                    selection.cursor.setPosition(at + 1, QTextCursor::KeepAnchor);
+                    m_parenthesisHilits.append(selection);
+                }
             }
         }
 
-        auto format = m_syntaxStyle->getFormat("Parentheses");
-
-        // Found
-        if (counter == 0)
-        {
-            ExtraSelection selection{};
-
-            auto directionEnum = direction < 0 ? QTextCursor::MoveOperation::Left : QTextCursor::MoveOperation::Right;
-
-            // NOTE font weight is not supported in ExtraSelection.
-            // See https://doc.qt.io/qt-5/qtextedit-extraselection.html#format-var
-            selection.format = format;
-            selection.cursor = textCursor();
-            selection.cursor.clearSelection();
-            selection.cursor.setPosition(position);
-            selection.cursor.movePosition(QTextCursor::MoveOperation::Right, QTextCursor::MoveMode::KeepAnchor, 1);
-
-            m_parenAndCurLineHilits.append(selection);
-
-            selection.cursor = textCursor();
-            selection.cursor.clearSelection();
-            selection.cursor.movePosition(directionEnum, QTextCursor::MoveMode::KeepAnchor, 1);
-
-            m_parenAndCurLineHilits.append(selection);
-        }
-
         break;
     }
+
+    setDecorations("Parentheses", decorations, 1);
+    setExtraSelections(m_parenthesisHilits);
 }
 
 void QCodeEditor::highlightCurrentLine()
 {
+    QVector<Decoration> decorations;
+
     if (!isReadOnly())
     {
-        QTextEdit::ExtraSelection selection{};
+        auto format = m_syntaxStyle->getFormat("CurrentLine");
+        format.setForeground(QBrush());
+        format.setProperty(QTextFormat::FullWidthSelection, true);
 
-        selection.format = m_syntaxStyle->getFormat("CurrentLine");
-        selection.format.setForeground(QBrush());
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
-
-        m_parenAndCurLineHilits.append(selection);
+        auto position = textCursor().position();
+        decorations.append({position, position, format});
     }
+
+    setDecorations("CurrentLine", decorations, -1);
 }
 
 void QCodeEditor::highlightWordOccurrences()
@@ -539,34 +738,154 @@ void QCodeEditor::highlightWordOccurrences()
     static QRegularExpression RE_WORD(
         R"((?:[_a-zA-Z][_a-zA-Z0-9]*)|(?<=\b|\s|^)(?i)(?:(?:(?:(?:(?:\d+(?:'\d+)*)?\.(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)\.(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)?\.(?:[0-9a-f]+(?:'[0-9a-f]+)*)(?:p[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)\.?(?:p[+-]?(?:\d+(?:'\d+)*))))[lf]?)|(?:(?:(?:[1-9]\d*(?:'\d+)*)|(?:0[0-7]*(?:'[0-7]+)*)|(?:0x[0-9a-f]+(?:'[0-9a-f]+)*)|(?:0b[01]+(?:'[01]+)*))(?:u?l{0,2}|l{0,2}u?)))(?=\b|\s|$))");
 
-    auto curCursor = textCursor();
-    if (curCursor.hasSelection())
+    QString word;
+    auto cursor = textCursor();
+    if (cursor.hasSelection())
     {
-        auto text = curCursor.selectedText();
+        auto text = cursor.selectedText();
         if (RE_WORD.match(text).captured() == text)
+            word = text;
+    }
+
+    // The index of the previous word is kept up to date by the engine,
+    // so selecting another occurrence of it doesn't search again
+    if (word != m_wordOccurrenceText)
+    {
+        m_wordOccurrenceText = word;
+        if (word.isEmpty())
+            m_wordOccurrences->clear();
+        else
+            m_wordOccurrences->setPattern(QSearchEngine::plainTextPattern(word, true, true));
+    }
+
+    viewport()->update();
+}
+
+void QCodeEditor::paintWordOccurrences(QPainter &painter)
+{
+    auto cursor = textCursor();
+    if (m_wordOccurrenceText.isEmpty() || cursor.selectedText() != m_wordOccurrenceText)
+        return;
+
+    int firstVisible = cursorForPosition(QPoint(0, 0)).position();
+    int lastVisible = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+
+    QVector<QSearchEngine::Match> matches;
+    if (m_wordOccurrences->isSearching())
+    {
+        // Until the background scan is done, only the visible lines are searched
+        QTextCursor visible(document());
+        visible.setPosition(document()->findBlock(firstVisible).position());
+        visible.setPosition(lastVisible, QTextCursor::KeepAnchor);
+        visible.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+
+        auto text = visible.selectedText().replace(QChar::ParagraphSeparator, '\n');
+        auto matchIterator = m_wordOccurrences->pattern().globalMatch(text);
+        while (matchIterator.hasNext())
         {
-            auto doc = document();
-            auto wordCursor = doc->find(text, 0, QTextDocument::FindWholeWords | QTextDocument::FindCaseSensitively);
-            ExtraSelection e;
-            e.format.setBackground(m_syntaxStyle->getFormat("WordOccurrence").background());
-            while (!wordCursor.isNull())
-            {
-                if (wordCursor != curCursor)
-                {
-                    e.cursor = wordCursor;
-                    m_wordOccurHilits.push_back(e);
-                }
-                wordCursor =
-                    doc->find(text, wordCursor, QTextDocument::FindWholeWords | QTextDocument::FindCaseSensitively);
-            }
+            auto match = matchIterator.next();
+            matches.append({visible.selectionStart() + static_cast<int>(match.capturedStart()),
+                            static_cast<int>(match.capturedLength())});
         }
     }
+    else
+    {
+        matches = m_wordOccurrences->matchesInRange(firstVisible, lastVisible + 1);
+    }
+
+    auto brush = m_syntaxStyle->getFormat("WordOccurrence").background();
+    for (auto &&match : qAsConst(matches))
+    {
+        if (match.start != cursor.selectionStart())
+            paintTextRange(painter, match.start, match.start + match.length, brush);
+    }
 }
 
 void QCodeEditor::paintEvent(QPaintEvent *e)
 {
     updateLineNumberArea(e->rect());
+
+    // Decorations, word occurrences and selections of extra carets go below the text, the carets above it
+    {
+        QPainter painter(viewport());
+        paintDecorations(painter);
+        paintWordOccurrences(painter);
+        paintExtraCursors(painter, false);
+    }
+
     QTextEdit::paintEvent(e);
+
+    QPainter painter(viewport());
+    paintBracketColors(painter);
+    paintExtraCursors(painter, true);
+}
+
+void QCodeEditor::paintBracketColors(QPainter &painter)
+{
+    if (!m_bracketPairColorization || m_syntaxStyle == nullptr)
+        return;
+
+    // Styles without bracket levels leave the brackets alone
+    QVector<QColor> colors;
+    for (int level = 1; level <= 3; ++level)
+    {
+        auto format = m_syntaxStyle->getFormat(QString("Bracket.Level%1").arg(level));
+        if (format.hasProperty(QTextFormat::ForegroundBrush))
+            colors.append(format.foreground().color());
+    }
+
+    if (colors.isEmpty())
+        return;
+
+    // Selected text and the matching parentheses keep their own colors
+    auto cursor = textCursor();
+    QVector<int> skipped;
+    for (auto &&decoration : decorations("Parentheses"))
+    {
+        if (decoration.format.hasProperty(QTextFormat::ForegroundBrush))
+            skipped.append(decoration.start);
+    }
+
+    auto block = cursorForPosition(QPoint(0, 0)).block();
+    auto end = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).block().next();
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+
+    // Depth is resolved once, the brackets of the visible blocks carry it on
+    auto index = QBracketIndex::get(document());
+    auto depth = index == nullptr ? 0 : index->depth(block);
+    auto count = static_cast<int>(colors.size());
+
+    for (; block.isValid() && block != end; block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data == nullptr)
+            continue;
+
+        auto layout = block.layout();
+        for (auto &&bracket : data->brackets)
+        {
+            auto opening =
+                std::any_of(data->bracketSummaries.cbegin(), data->bracketSummaries.cend(),
+                            [&bracket](const auto &summary) { return summary.open == bracket.character; });
+
+            // A closing bracket gets the level of its opening one
+            if (!opening)
+                --depth;
+
+            // The glyph is drawn again over the one of the layout
+            auto position = block.position() + bracket.position;
+            auto selected = cursor.selectionStart() <= position && position < cursor.selectionEnd();
+            if (block.isVisible() && layout != nullptr && !selected && !skipped.contains(position))
+            {
+                painter.setPen(colors.at((depth % count + count) % count));
+                for (auto &&run : layout->glyphRuns(bracket.position, 1))
+                    painter.drawGlyphRun(layout->position() + offset, run);
+            }
+
+            if (opening)
+                ++depth;
+        }
+    }
 }
 
 QTextBlock QCodeEditor::getFirstVisibleBlock()
@@ -597,7 +916,9 @@ QTextBlock QCodeEditor::getFirstVisibleBlock()
 
 bool QCodeEditor::proceedCompleterBegin(QKeyEvent *e)
 {
-    if (m_completer && m_completer->popup()->isVisible())
+    auto completer = activeCompleter();
+
+    if (completer && completer->popup()->isVisible())
     {
         switch (e->key())
         {
@@ -616,14 +937,15 @@ bool QCodeEditor::proceedCompleterBegin(QKeyEvent *e)
     // todo: Replace with modifiable QShortcut
     auto isShortcut = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
 
-    return !(!m_completer || !isShortcut);
+    return !(!completer || !isShortcut);
 }
 
 void QCodeEditor::proceedCompleterEnd(QKeyEvent *e)
 {
+    auto completer = activeCompleter();
     auto ctrlOrShift = e->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier);
 
-    if (!m_completer || (ctrlOrShift && e->text().isEmpty()) || e->key() == Qt::Key_Delete)
+    if (!completer || (ctrlOrShift && e->text().isEmpty()) || e->key() == Qt::Key_Delete)
     {
         return;
     }
@@ -635,123 +957,325 @@ void QCodeEditor::proceedCompleterEnd(QKeyEvent *e)
 
     if (!isShortcut && (e->text().isEmpty() || completionPrefix.length() < 2 || eow.contains(e->text().right(1))))
     {
-        m_completer->popup()->hide();
+        hideCompletions();
+        return;
+    }
+
+    // Provided completions arrive later, typing goes on meanwhile
+    if (completer == m_completionPopup)
+    {
+        if (completionProvider())
+            requestCompletions(completionPrefix, isShortcut);
+        else
+            hideCompletions();
+
         return;
     }
 
-    if (completionPrefix != m_completer->completionPrefix())
+    if (completionPrefix != completer->completionPrefix())
     {
-        m_completer->setCompletionPrefix(completionPrefix);
-        m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+        completer->setCompletionPrefix(completionPrefix);
+        completer->popup()->setCurrentIndex(completer->completionModel()->index(0, 0));
     }
 
     auto cursRect = cursorRect();
-    cursRect.setWidth(m_completer->popup()->sizeHintForColumn(0) +
-                      m_completer->popup()->verticalScrollBar()->sizeHint().width());
+    cursRect.setWidth(completionPopupWidth(completer));
 
-    m_completer->complete(cursRect);
+    completer->complete(cursRect);
 }
 
-void QCodeEditor::keyPressEvent(QKeyEvent *e)
+QCompleter *QCodeEditor::activeCompleter() const
 {
-    auto completerSkip = proceedCompleterBegin(e);
-
-    if (!completerSkip)
-    {
-        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() != Qt::NoModifier)
-        {
-            QKeyEvent pureEnter(QEvent::KeyPress, Qt::Key_Enter, Qt::NoModifier);
-            if (e->modifiers() == Qt::ControlModifier)
-            {
-                livecodeTrigger();
-                return;
-            }
-            else if (e->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
-            {
-                if (textCursor().blockNumber() == 0)
-                {
-                    moveCursor(QTextCursor::StartOfBlock);
-                    insertPlainText("\n");
-                    moveCursor(QTextCursor::PreviousBlock);
-                    moveCursor(QTextCursor::EndOfBlock);
-                }
-                else
-                {
-                    moveCursor(QTextCursor::PreviousBlock);
-                    moveCursor(QTextCursor::EndOfBlock);
-                    keyPressEvent(&pureEnter);
-                }
-                return;
-            }
-            else if (e->modifiers() == Qt::ShiftModifier)
-            {
-                keyPressEvent(&pureEnter);
-                return;
-            }
-        }
+    // Choices of snippets are shown by the editor's popup, even without a provider
+    if (completionProvider() || m_completionPopup->popup()->isVisible())
+        return m_completionPopup;
 
-        if (e->key() == Qt::Key_Tab && e->modifiers() == Qt::NoModifier)
-        {
-            if (textCursor().hasSelection())
-            {
-                indent();
-                return;
-            }
+    return m_completer;
+}
 
-            auto c = charUnderCursor();
-            for (auto p : qAsConst(m_parentheses))
-            {
-                if (p.tabJumpOut && c == p.right)
-                {
-                    moveCursor(QTextCursor::NextCharacter);
-                    return;
-                }
-            }
+void QCodeEditor::requestCompletions(const QString &prefix, bool explicitRequest)
+{
+    auto cursor = textCursor();
 
-            if (m_replaceTab)
-            {
-                insertPlainText(m_tabReplace);
-                return;
-            }
-        }
+    QCompletionProvider::Context context{prefix, cursor.block().text(), cursor.blockNumber(),
+                                         cursor.positionInBlock(), explicitRequest, {}};
+    auto provider = completionProvider();
 
-        if (e->key() == Qt::Key_Backtab && e->modifiers() == Qt::ShiftModifier)
+    if (m_documentWordCompletion)
+    {
+        // Only identifiers, that may match the prefix, are measured. The word being typed is indexed
+        // already, but it's only a completion if it occurs elsewhere too.
+        auto identifiers = m_identifierIndex->identifiersMatching(prefix, context.line);
+        context.documentWords.reserve(static_cast<int>(identifiers.size()));
+        for (auto &&identifier : identifiers)
         {
-            unindent();
-            return;
-        }
+            if (identifier.identifier == prefix && identifier.count <= 1)
+                continue;
 
-        if (e->key() == Qt::Key_Delete && e->modifiers() == Qt::ShiftModifier)
-        {
-            deleteLine();
-            return;
+            context.documentWords.append({identifier.identifier, identifier.count, identifier.distance});
         }
 
-        // Auto indentation
+        provider = QSharedPointer<QDocumentWordCompletionProvider>::create(provider);
+    }
 
-        static QRegularExpression RE_LINE_START_WHITESPACE("^\\s*");
+    m_completionEngine->request(provider, context);
+}
 
-        QString indentationSpaces = RE_LINE_START_WHITESPACE.match(textCursor().block().text()).captured();
+void QCodeEditor::showCompletions(const QStringList &completions, bool first)
+{
+    auto popup = m_completionPopup->popup();
 
-        // Have Qt Edior like behaviour, if {|} and enter is pressed indent the two
-        // parenthesis
-        if (m_autoIndentation && (e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) &&
-            e->modifiers() == Qt::NoModifier && charUnderCursor(-1) == '{' && charUnderCursor() == '}')
+    // Later batches don't bring back a popup, that was closed meanwhile
+    if (!first && !popup->isVisible())
+        return;
+
+    auto current = 0;
+    if (first)
+    {
+        m_completionPopupWidth = CompletionPopupWidth();
+        m_completionModel->setStringList(completions);
+    }
+    else
+    {
+        current = qMax(0, popup->currentIndex().row());
+
+        auto row = m_completionModel->rowCount();
+        m_completionModel->insertRows(row, static_cast<int>(completions.size()));
+        for (int i = 0; i < completions.size(); ++i)
+            m_completionModel->setData(m_completionModel->index(row + i), completions.at(i));
+    }
+
+    auto cursRect = cursorRect();
+    cursRect.setWidth(completionPopupWidth(m_completionPopup));
+
+    m_completionPopup->complete(cursRect);
+    popup->setCurrentIndex(m_completionPopup->completionModel()->index(current, 0));
+}
+
+int QCodeEditor::completionPopupWidth(QCompleter *completer)
+{
+    // Rows further down are only seen by scrolling, they may be cut off
+    static const int MAXIMUM_MEASURED_ROWS = 64;
+
+    auto popup = completer->popup();
+    auto model = completer->completionModel();
+    auto rows = qMin(model->rowCount(), MAXIMUM_MEASURED_ROWS);
+
+    auto &cache = m_completionPopupWidth;
+    if (cache.completer != completer || cache.model != completer->model() ||
+        cache.prefix != completer->completionPrefix() || cache.rows > rows)
+        cache = {completer, completer->model(), completer->completionPrefix(), 0, 0};
+
+    // Rows, that were appended to the same completions, are measured on their own
+    for (; cache.rows < rows; ++cache.rows)
+        cache.width = qMax(cache.width, popup->sizeHintForIndex(model->index(cache.rows, 0)).width());
+
+    return cache.width + popup->verticalScrollBar()->sizeHint().width();
+}
+
+bool QCodeEditor::proceedSnippetKey(QKeyEvent *e)
+{
+    if (!m_snippetSession->isActive())
+        return false;
+
+    if (e->key() == Qt::Key_Tab && e->modifiers() == Qt::NoModifier)
+    {
+        nextSnippetField();
+        return true;
+    }
+
+    if (e->key() == Qt::Key_Backtab)
+    {
+        previousSnippetField();
+        return true;
+    }
+
+    if (e->key() == Qt::Key_Escape && e->modifiers() == Qt::NoModifier)
+    {
+        exitSnippet();
+        return true;
+    }
+
+    return false;
+}
+
+bool QCodeEditor::proceedLinkedFieldKey(QKeyEvent *e)
+{
+    if (!m_snippetSession->isActive())
+        return false;
+
+    auto cursor = textCursor();
+    auto text = e->text();
+
+    // Backspace and Delete remove the character next to the caret, unless there's a selection
+    if (e->key() == Qt::Key_Backspace || e->key() == Qt::Key_Delete)
+    {
+        if (e->modifiers() != Qt::NoModifier)
+            return false;
+
+        text.clear();
+        if (!cursor.hasSelection())
+            cursor.movePosition(e->key() == Qt::Key_Backspace ? QTextCursor::PreviousCharacter
+                                                                : QTextCursor::NextCharacter,
+                                QTextCursor::KeepAnchor);
+    }
+    else if (text.isEmpty() || !text.at(0).isPrint())
+        return false;
+
+    if (!m_snippetSession->replaceLinked(cursor, text))
+        return false;
+
+    setTextCursor(cursor);
+    return true;
+}
+
+void QCodeEditor::selectSnippetField()
+{
+    auto range = m_snippetSession->currentRange();
+
+    auto cursor = textCursor();
+    cursor.setPosition(range.first);
+    cursor.setPosition(range.second, QTextCursor::KeepAnchor);
+    setTextCursor(cursor);
+
+    auto choices = m_snippetSession->currentChoices();
+    if (!choices.isEmpty())
+    {
+        m_completionEngine->cancel();
+        showCompletions(choices, true);
+    }
+}
+
+void QCodeEditor::hideCompletions()
+{
+    m_completionEngine->cancel();
+
+    auto completer = activeCompleter();
+    if (completer)
+        completer->popup()->hide();
+}
+
+void QCodeEditor::keyPressEvent(QKeyEvent *e)
+{
+    // Idle work waits until typing pauses
+    m_scheduler->postpone();
+
+    // Each key press starts a new undo step, unless it continues the typed word
+    m_undoHistory->closeStep();
+
+    if (e->matches(QKeySequence::Undo))
+    {
+        hideCompletions();
+        undoStep();
+        return;
+    }
+
+    if (e->matches(QKeySequence::Redo))
+    {
+        hideCompletions();
+        redoStep();
+        return;
+    }
+
+    auto completerSkip = proceedCompleterBegin(e);
+
+    if (!completerSkip && proceedSnippetKey(e))
+    {
+        return;
+    }
+
+    if (!completerSkip && proceedBlockSelectionKey(e))
+    {
+        return;
+    }
+
+    if (!completerSkip && !m_extraCursors.isEmpty() && proceedMultiCursorKey(e))
+    {
+        proceedCompleterEnd(e);
+        return;
+    }
+
+    if (!completerSkip)
+    {
+        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() != Qt::NoModifier)
+        {
+            QKeyEvent pureEnter(QEvent::KeyPress, Qt::Key_Enter, Qt::NoModifier);
+            if (e->modifiers() == Qt::ControlModifier)
+            {
+                livecodeTrigger();
+                return;
+            }
+            else if (e->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
+            {
+                if (textCursor().blockNumber() == 0)
+                {
+                    moveCursor(QTextCursor::StartOfBlock);
+                    insertPlainText("\n");
+                    moveCursor(QTextCursor::PreviousBlock);
+                    moveCursor(QTextCursor::EndOfBlock);
+                }
+                else
+                {
+                    moveCursor(QTextCursor::PreviousBlock);
+                    moveCursor(QTextCursor::EndOfBlock);
+                    keyPressEvent(&pureEnter);
+                }
+                return;
+            }
+            else if (e->modifiers() == Qt::ShiftModifier)
+            {
+                keyPressEvent(&pureEnter);
+                return;
+            }
+        }
+
+        if (e->key() == Qt::Key_Tab && e->modifiers() == Qt::NoModifier)
         {
-            insertPlainText("\n" + indentationSpaces + (m_replaceTab ? m_tabReplace : "\t") + "\n" + indentationSpaces);
+            if (textCursor().hasSelection())
+            {
+                indent();
+                return;
+            }
+
+            auto c = charUnderCursor();
+            for (auto p : qAsConst(m_parentheses))
+            {
+                if (p.tabJumpOut && c == p.right)
+                {
+                    moveCursor(QTextCursor::NextCharacter);
+                    return;
+                }
+            }
+
+            if (m_replaceTab)
+            {
+                insertPlainText(m_tabReplace);
+                return;
+            }
+        }
 
-            for (int i = 0; i <= indentationSpaces.length(); ++i)
-                moveCursor(QTextCursor::MoveOperation::Left);
+        if (e->key() == Qt::Key_Backtab && e->modifiers() == Qt::ShiftModifier)
+        {
+            unindent();
+            return;
+        }
 
+        if (e->key() == Qt::Key_Delete && e->modifiers() == Qt::ShiftModifier)
+        {
+            deleteLine();
             return;
         }
 
-        // Auto-indent for single "{" without "}"
+        // Auto indentation
+
+        static QRegularExpression RE_LINE_START_WHITESPACE("^\\s*");
+
+        QString indentationSpaces = RE_LINE_START_WHITESPACE.match(textCursor().block().text()).captured();
+
         if (m_autoIndentation && (e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) &&
-            e->modifiers() == Qt::NoModifier && charUnderCursor(-1) == '{')
+            e->modifiers() == Qt::NoModifier)
         {
-            insertPlainText("\n" + indentationSpaces + (m_replaceTab ? m_tabReplace : "\t"));
-            setTextCursor(textCursor()); // scroll to the cursor
+            insertIndentedLineBreak();
             return;
         }
 
@@ -865,12 +1389,122 @@ void QCodeEditor::keyPressEvent(QKeyEvent *e)
             setTextCursor(cursor);
         }
 
-        QTextEdit::keyPressEvent(e);
+        // Typing into a linked tab stop changes its copies in the same edit
+        if (!proceedLinkedFieldKey(e))
+            QTextEdit::keyPressEvent(e);
+
+        // Closing brackets and words, that end a block, unindent their line as they're typed
+        if (m_autoIndentation && !e->text().isEmpty() && !textCursor().hasSelection())
+        {
+            auto cursor = textCursor();
+            if (indentationEngine()->isElectric(cursor.block().text().left(cursor.positionInBlock())))
+                reindentLines(cursor.blockNumber(), cursor.blockNumber(), true);
+        }
     }
 
     proceedCompleterEnd(e);
 }
 
+void QCodeEditor::contextMenuEvent(QContextMenuEvent *e)
+{
+    auto menu = createStandardContextMenu(e->pos());
+
+    // The standard actions would undo by the document, whose own stack is disabled while the history is used
+    for (auto &&action : menu->actions())
+    {
+        if (action->objectName() == "edit-undo")
+        {
+            action->disconnect();
+            connect(action, &QAction::triggered, this, &QCodeEditor::undoStep);
+            if (m_undoHistory->isEnabled())
+                action->setEnabled(m_undoHistory->isUndoAvailable());
+        }
+        else if (action->objectName() == "edit-redo")
+        {
+            action->disconnect();
+            connect(action, &QAction::triggered, this, &QCodeEditor::redoStep);
+            if (m_undoHistory->isEnabled())
+                action->setEnabled(m_undoHistory->isRedoAvailable());
+        }
+    }
+
+    menu->exec(e->globalPos());
+    delete menu;
+}
+
+void QCodeEditor::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() == Qt::LeftButton && e->modifiers() == (Qt::ControlModifier | Qt::AltModifier))
+    {
+        auto cursor = cursorForPosition(e->pos());
+        m_extraCursors.append({textCursor().anchor(), textCursor().position()});
+        setTextCursor(cursor);
+        mergeCursors();
+        viewport()->update();
+        return;
+    }
+
+    if (e->button() == Qt::LeftButton && e->modifiers() == Qt::AltModifier)
+    {
+        auto line = cursorForPosition(e->pos()).blockNumber();
+        auto column = visualColumnAt(e->pos());
+        m_blockSelecting = true;
+        setBlockSelection(line, column, line, column);
+        return;
+    }
+
+    clearExtraCursors();
+    QTextEdit::mousePressEvent(e);
+}
+
+void QCodeEditor::mouseMoveEvent(QMouseEvent *e)
+{
+    if (m_blockSelecting)
+    {
+        setBlockSelection(m_blockSelection.anchorLine, m_blockSelection.anchorColumn,
+                          cursorForPosition(e->pos()).blockNumber(), visualColumnAt(e->pos()));
+        return;
+    }
+
+    QTextEdit::mouseMoveEvent(e);
+}
+
+void QCodeEditor::mouseReleaseEvent(QMouseEvent *e)
+{
+    if (m_blockSelecting && e->button() == Qt::LeftButton)
+    {
+        m_blockSelecting = false;
+        return;
+    }
+
+    QTextEdit::mouseReleaseEvent(e);
+}
+
+QMimeData *QCodeEditor::createMimeDataFromSelection() const
+{
+    if (m_extraCursors.isEmpty())
+        return QTextEdit::createMimeDataFromSelection();
+
+    auto carets = m_extraCursors;
+    carets.append({textCursor().anchor(), textCursor().position()});
+    std::sort(carets.begin(), carets.end(),
+              [](const Caret &lhs, const Caret &rhs) { return lhs.start() < rhs.start(); });
+
+    QStringList lines;
+    lines.reserve(carets.size());
+    QTextCursor cursor(document());
+    for (auto &&caret : qAsConst(carets))
+    {
+        cursor.setPosition(caret.anchor);
+        cursor.setPosition(caret.position, QTextCursor::KeepAnchor);
+        lines.append(cursor.selectedText().replace(QChar::ParagraphSeparator, '\n'));
+    }
+
+    auto data = new QMimeData;
+    data->setText(lines.join('\n'));
+    return data;
+}
+
 void QCodeEditor::setAutoIndentation(bool enabled)
 {
     m_autoIndentation = enabled;
@@ -879,6 +1513,13 @@ void QCodeEditor::setAutoIndentation(bool enabled)
 void QCodeEditor::setParentheses(const QVector<Parenthesis> &parentheses)
 {
     m_parentheses = parentheses;
+
+    auto pairs = bracketPairsOf(m_parentheses);
+    if (m_highlighter && m_highlighter->bracketPairs() != pairs)
+    {
+        m_highlighter->setBracketPairs(pairs);
+        m_highlighter->rehighlightParallel();
+    }
 }
 
 void QCodeEditor::setExtraBottomMargin(bool enabled)
@@ -892,6 +1533,27 @@ bool QCodeEditor::autoIndentation() const
     return m_autoIndentation;
 }
 
+void QCodeEditor::setBracketPairColorization(bool enabled)
+{
+    m_bracketPairColorization = enabled;
+    viewport()->update();
+}
+
+bool QCodeEditor::bracketPairColorization() const
+{
+    return m_bracketPairColorization;
+}
+
+void QCodeEditor::setDocumentWordCompletion(bool enabled)
+{
+    m_documentWordCompletion = enabled;
+}
+
+bool QCodeEditor::documentWordCompletion() const
+{
+    return m_documentWordCompletion;
+}
+
 void QCodeEditor::setTabReplace(bool enabled)
 {
     m_replaceTab = enabled;
@@ -1020,43 +1682,221 @@ bool QCodeEditor::event(QEvent *event)
 
 void QCodeEditor::insertCompletion(const QString &s)
 {
-    if (m_completer->widget() != this)
+    auto completer = activeCompleter();
+    if (completer && completer->widget() != this)
     {
         return;
     }
 
+    // A running request would open the popup again
+    m_completionEngine->cancel();
+
     auto tc = textCursor();
+
+    // A choice replaces the current tab stop of the snippet
+    auto range = m_snippetSession->currentRange();
+    if (!m_snippetSession->currentChoices().isEmpty() && range.first <= tc.position() && tc.position() <= range.second)
+    {
+        tc.setPosition(range.first);
+        tc.setPosition(range.second, QTextCursor::KeepAnchor);
+        tc.insertText(s);
+        setTextCursor(tc);
+        return;
+    }
+
     tc.select(QTextCursor::SelectionType::WordUnderCursor);
+
+    auto snippet = m_completionEngine->snippet(s);
+    if (!snippet.isEmpty())
+    {
+        setTextCursor(tc);
+        insertSnippet(snippet);
+        return;
+    }
+
     tc.insertText(s);
     setTextCursor(tc);
 }
 
-QCompleter *QCodeEditor::completer() const
-{
-    return m_completer;
-}
-
-void QCodeEditor::addDiagnostic(DiagnosticSeverity severity, const Span &span, const QString &message,
-                                const QString &code)
+void QCodeEditor::insertSnippet(const QSnippet &snippet)
 {
-    if (span.end < span.start)
-        return;
+    m_snippetSession->stop();
 
-    auto i = m_diagnostics.size();
-    m_diagnostics.push_back(Diagnostic(severity, span, message, code));
-    m_diagSpans.insert(InternalSpan(span.start, span.end, i));
+    auto cursor = textCursor();
+    auto position = cursor.selectionStart();
+    auto lineText = document()->findBlock(position).text();
 
-    auto cursor = this->textCursor();
-    cursor.setPosition(span.start);
-    cursor.setPosition(span.end, QTextCursor::KeepAnchor);
+    int indentation = 0;
+    while (indentation < lineText.length() && lineText.at(indentation).isSpace())
+        ++indentation;
 
-    QTextCharFormat charfmt;
+    // The whole text is inserted at once, the tab stops are known from the snippet
+    auto indented = snippet.indented(lineText.left(indentation));
+    cursor.insertText(indented.text());
 
-    switch (severity)
+    if (m_snippetSession->start(indented, position))
     {
-    case DiagnosticSeverity::Error:
-        charfmt.setUnderlineColor(m_syntaxStyle->getFormat("Error").underlineColor());
-        charfmt.setUnderlineStyle(m_syntaxStyle->getFormat("Error").underlineStyle());
+        selectSnippetField();
+        return;
+    }
+
+    cursor.setPosition(m_snippetSession->finalPosition());
+    setTextCursor(cursor);
+}
+
+bool QCodeEditor::isSnippetActive() const
+{
+    return m_snippetSession->isActive();
+}
+
+void QCodeEditor::setUndoHistoryEnabled(bool enabled)
+{
+    m_undoHistory->setEnabled(enabled);
+}
+
+bool QCodeEditor::isUndoHistoryEnabled() const
+{
+    return m_undoHistory->isEnabled();
+}
+
+void QCodeEditor::setUndoMemoryLimit(qint64 bytes)
+{
+    m_undoHistory->setMemoryLimit(bytes);
+}
+
+qint64 QCodeEditor::undoMemoryLimit() const
+{
+    return m_undoHistory->memoryLimit();
+}
+
+qint64 QCodeEditor::undoMemoryUsage() const
+{
+    return m_undoHistory->memoryUsage();
+}
+
+void QCodeEditor::clearUndoHistory()
+{
+    if (m_undoHistory->isEnabled())
+        m_undoHistory->clear();
+    else
+        document()->clearUndoRedoStacks();
+}
+
+void QCodeEditor::undoStep()
+{
+    // Linked tab stops would be updated by the reverted text
+    m_snippetSession->stop();
+    clearExtraCursors();
+
+    if (!m_undoHistory->isEnabled())
+    {
+        undo();
+        return;
+    }
+
+    auto position = m_undoHistory->undo();
+    if (position < 0)
+        return;
+
+    auto cursor = textCursor();
+    cursor.setPosition(position);
+    setTextCursor(cursor);
+}
+
+void QCodeEditor::redoStep()
+{
+    m_snippetSession->stop();
+    clearExtraCursors();
+
+    if (!m_undoHistory->isEnabled())
+    {
+        redo();
+        return;
+    }
+
+    auto position = m_undoHistory->redo();
+    if (position < 0)
+        return;
+
+    auto cursor = textCursor();
+    cursor.setPosition(position);
+    setTextCursor(cursor);
+}
+
+void QCodeEditor::nextSnippetField()
+{
+    if (!m_snippetSession->isActive())
+        return;
+
+    if (m_snippetSession->next())
+    {
+        selectSnippetField();
+        return;
+    }
+
+    // After the last tab stop the cursor goes to the final one
+    auto cursor = textCursor();
+    cursor.setPosition(m_snippetSession->finalPosition());
+    m_snippetSession->stop();
+    setTextCursor(cursor);
+}
+
+void QCodeEditor::previousSnippetField()
+{
+    if (m_snippetSession->previous())
+        selectSnippetField();
+}
+
+void QCodeEditor::exitSnippet()
+{
+    m_snippetSession->stop();
+}
+
+QCompleter *QCodeEditor::completer() const
+{
+    return m_completer;
+}
+
+void QCodeEditor::setCompletionProvider(const QSharedPointer<QCompletionProvider> &provider)
+{
+    hideCompletions();
+    m_completionProvider = provider;
+}
+
+QSharedPointer<QCompletionProvider> QCodeEditor::completionProvider() const
+{
+    if (m_completionProvider)
+        return m_completionProvider;
+
+    // Built in completers complete through their provider
+    auto languageCompleter = qobject_cast<QLanguageCompleter *>(m_completer);
+    if (languageCompleter)
+        return languageCompleter->completionProvider();
+
+    return QSharedPointer<QCompletionProvider>();
+}
+
+void QCodeEditor::addDiagnostic(DiagnosticSeverity severity, const Span &span, const QString &message,
+                                const QString &code)
+{
+    if (span.end < span.start)
+        return;
+
+    auto i = m_diagnostics.size();
+    m_diagnostics.push_back(Diagnostic(severity, span, message, code));
+    m_diagSpans.insert(InternalSpan(span.start, span.end, i));
+
+    auto cursor = this->textCursor();
+    cursor.setPosition(span.start);
+    cursor.setPosition(span.end, QTextCursor::KeepAnchor);
+
+    QTextCharFormat charfmt;
+
+    switch (severity)
+    {
+    case DiagnosticSeverity::Error:
+        charfmt.setUnderlineColor(m_syntaxStyle->getFormat("Error").underlineColor());
+        charfmt.setUnderlineStyle(m_syntaxStyle->getFormat("Error").underlineStyle());
         break;
     case DiagnosticSeverity::Warning:
         charfmt.setUnderlineColor(m_syntaxStyle->getFormat("Warning").underlineColor());
@@ -1101,6 +1941,266 @@ void QCodeEditor::clearDiagnostics()
     update();
 }
 
+void QCodeEditor::setSemanticTokens(const QStringList &legend, const QVector<quint32> &data)
+{
+    if (m_highlighter == nullptr)
+        return;
+
+    m_highlighter->setSemanticTokens(legend, data);
+}
+
+void QCodeEditor::applySemanticTokensEdits(const QVector<QStyleSyntaxHighlighter::SemanticTokensEdit> &edits)
+{
+    if (m_highlighter == nullptr)
+        return;
+
+    m_highlighter->applySemanticTokensEdits(edits);
+}
+
+QVector<QHighlightToken> QCodeEditor::blockTokens(const QTextBlock &block) const
+{
+    auto data = QCodeBlockData::get(block);
+    if (data == nullptr)
+        return {};
+
+    return data->tokens;
+}
+
+QString QCodeEditor::tokenFormatAt(int position) const
+{
+    auto block = document()->findBlock(position);
+    auto data = QCodeBlockData::get(block);
+    if (data == nullptr)
+        return QString();
+
+    auto column = position - block.position();
+    const auto &tokens = data->tokens;
+    auto it = std::upper_bound(tokens.begin(), tokens.end(), column,
+                               [](int value, const QHighlightToken &token) { return value < token.start; });
+    if (it == tokens.begin())
+        return QString();
+
+    --it;
+    if (column < it->start + it->length)
+        return it->formatName;
+
+    return QString();
+}
+
+static QVector<QCodeBlockData::Bracket> bracketsOf(const QTextBlock &block, QChar open, QChar close)
+{
+    auto data = QCodeBlockData::get(block);
+    if (data != nullptr && data->bracketSummary(open, close) != nullptr)
+        return data->brackets;
+
+    // Blocks, that weren't highlighted, are matched as plain text
+    QVector<QCodeBlockData::Bracket> brackets;
+    auto text = block.text();
+    for (int i = 0; i < text.length(); ++i)
+    {
+        if (text.at(i) == open || text.at(i) == close)
+            brackets.append({i, text.at(i)});
+    }
+
+    return brackets;
+}
+
+int QCodeEditor::matchingParenthesis(int position) const
+{
+    auto block = document()->findBlock(position);
+    if (!block.isValid())
+        return -1;
+
+    auto character = document()->characterAt(position);
+    auto index = QBracketIndex::get(document());
+
+    for (auto &&p : m_parentheses)
+    {
+        // Quotes can't be told apart, so they aren't matched
+        if (p.left == p.right || (character != p.left && character != p.right))
+            continue;
+
+        auto forward = character == p.left;
+        auto column = position - block.position();
+        auto brackets = bracketsOf(block, p.left, p.right);
+        auto it = std::lower_bound(
+            brackets.cbegin(), brackets.cend(), column,
+            [](const QCodeBlockData::Bracket &bracket, int value) { return bracket.position < value; });
+
+        // The parenthesis is in a string or a comment
+        if (it == brackets.cend() || it->position != column)
+            return -1;
+
+        // Depth counts the parentheses, that are still waiting for their match
+        int depth = 0;
+        auto step = [&depth, &p, forward](QChar value) {
+            if (value == p.left)
+                depth += forward ? 1 : -1;
+            else if (value == p.right)
+                depth += forward ? -1 : 1;
+
+            return depth == 0;
+        };
+
+        if (forward)
+        {
+            for (; it != brackets.cend(); ++it)
+            {
+                if (step(it->character))
+                    return block.position() + it->position;
+            }
+
+            for (block = block.next(); block.isValid(); block = block.next())
+            {
+                // Blocks and chunks of blocks, that can't hold the match, are skipped by their summaries
+                if (index != nullptr)
+                    block = index->findForward(block, p.left, p.right, depth);
+
+                if (!block.isValid())
+                    break;
+
+                brackets = bracketsOf(block, p.left, p.right);
+                for (it = brackets.cbegin(); it != brackets.cend(); ++it)
+                {
+                    if (step(it->character))
+                        return block.position() + it->position;
+                }
+            }
+        }
+        else
+        {
+            for (++it; it != brackets.cbegin();)
+            {
+                --it;
+                if (step(it->character))
+                    return block.position() + it->position;
+            }
+
+            for (block = block.previous(); block.isValid(); block = block.previous())
+            {
+                if (index != nullptr)
+                    block = index->findBackward(block, p.left, p.right, depth);
+
+                if (!block.isValid())
+                    break;
+
+                brackets = bracketsOf(block, p.left, p.right);
+                for (it = brackets.cend(); it != brackets.cbegin();)
+                {
+                    --it;
+                    if (step(it->character))
+                        return block.position() + it->position;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    return -1;
+}
+
+QVector<QTextCursor> QCodeEditor::extraCursors() const
+{
+    QVector<QTextCursor> cursors;
+    cursors.reserve(m_extraCursors.size());
+    for (auto &&caret : m_extraCursors)
+    {
+        QTextCursor cursor(document());
+        cursor.setPosition(caret.anchor);
+        cursor.setPosition(caret.position, QTextCursor::KeepAnchor);
+        cursors.append(cursor);
+    }
+
+    return cursors;
+}
+
+void QCodeEditor::addCursor(const QTextCursor &cursor)
+{
+    if (cursor.isNull() || cursor.document() != document())
+        return;
+
+    m_extraCursors.append({cursor.anchor(), cursor.position()});
+    mergeCursors();
+    viewport()->update();
+}
+
+void QCodeEditor::clearExtraCursors()
+{
+    m_hasBlockSelection = false;
+
+    if (m_extraCursors.isEmpty())
+        return;
+
+    m_extraCursors.clear();
+    viewport()->update();
+}
+
+void QCodeEditor::setBlockSelection(int anchorLine, int anchorColumn, int line, int column)
+{
+    auto lastLine = document()->blockCount() - 1;
+    m_blockSelection.anchorLine = qBound(0, anchorLine, lastLine);
+    m_blockSelection.anchorColumn = qMax(0, anchorColumn);
+    m_blockSelection.line = qBound(0, line, lastLine);
+    m_blockSelection.column = qMax(0, column);
+    m_hasBlockSelection = true;
+
+    updateBlockSelection();
+}
+
+bool QCodeEditor::hasBlockSelection() const
+{
+    return m_hasBlockSelection;
+}
+
+int QCodeEditor::wordOccurrenceCount() const
+{
+    return m_wordOccurrenceText.isEmpty() ? 0 : m_wordOccurrences->matchCount();
+}
+
+QIdentifierIndex *QCodeEditor::identifierIndex() const
+{
+    return m_identifierIndex;
+}
+
+void QCodeEditor::setDecorations(const QString &layer, const QVector<Decoration> &decorations, int z)
+{
+    auto &decorationLayer = m_decorationLayers[layer];
+    updateDecorations(decorationLayer);
+
+    decorationLayer.z = z;
+    decorationLayer.decorations = decorations;
+    std::stable_sort(decorationLayer.decorations.begin(), decorationLayer.decorations.end(),
+                     [](const Decoration &lhs, const Decoration &rhs) { return lhs.start < rhs.start; });
+    indexDecorations(decorationLayer);
+
+    updateDecorations(decorationLayer);
+}
+
+void QCodeEditor::clearDecorations(const QString &layer)
+{
+    auto it = m_decorationLayers.find(layer);
+    if (it == m_decorationLayers.end())
+        return;
+
+    updateDecorations(it.value());
+    m_decorationLayers.erase(it);
+}
+
+QVector<QCodeEditor::Decoration> QCodeEditor::decorations(const QString &layer) const
+{
+    auto it = m_decorationLayers.constFind(layer);
+    if (it == m_decorationLayers.cend())
+        return {};
+
+    QVector<Decoration> result;
+    result.reserve(it->decorations.size());
+    for (int i = 0; i < it->decorations.size(); ++i)
+        result.append(decorationAt(it.value(), i));
+
+    return result;
+}
+
 QChar QCodeEditor::charUnderCursor(int offset) const
 {
     return document()->characterAt(textCursor().position() + offset);
@@ -1115,46 +2215,81 @@ QString QCodeEditor::wordUnderCursor() const
 
 void QCodeEditor::insertFromMimeData(const QMimeData *source)
 {
-    insertPlainText(source->text());
+    m_undoHistory->closeStep();
+
+    if (m_extraCursors.isEmpty())
+    {
+        auto text = source->text();
+        auto start = textCursor().selectionStart();
+        auto block = document()->findBlock(start);
+        auto firstLine = block.blockNumber();
+
+        // The first line is indented too, if there's only whitespace before the paste
+        if (!block.text().left(start - block.position()).trimmed().isEmpty())
+            ++firstLine;
+
+        insertPlainText(text);
+
+        if (m_autoIndentation && text.contains('\n'))
+            reindentLines(firstLine, textCursor().blockNumber(), true);
+
+        return;
+    }
+
+    // One line per caret is distributed, otherwise each caret gets the whole text
+    auto text = source->text();
+    auto lines = text.split('\n');
+    if (lines.size() != m_extraCursors.size() + 1)
+        lines = QStringList(text);
+
+    padBlockSelection();
+
+    editCursors([&lines](QTextCursor &cursor, int index) {
+        cursor.insertText(lines.at(qMin(index, static_cast<int>(lines.size()) - 1)));
+    });
 }
 
 bool QCodeEditor::removeInEachLineOfSelection(const QRegularExpression &regex, bool force)
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
-    QString newText;
-    QTextStream stream(&newText);
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
+    int lineStart = firstBlock.blockNumber();
+    int lineEnd = lastBlock.blockNumber();
+
+    // Collect the ranges to remove first, so nothing is edited if a line doesn't match
+    QVector<QPair<int, int>> removals;
+    removals.reserve(lineEnd - lineStart + 1);
     int deleteTotal = 0, deleteFirst = 0;
-    for (int i = lineStart; i <= lineEnd; ++i)
+    for (auto block = firstBlock;; block = block.next())
     {
-        auto line = lines[i];
-        auto match = regex.match(line).captured(1);
-        int len = match.length();
+        auto match = regex.match(block.text());
+        int len = static_cast<int>(match.capturedLength(1));
         if (len == 0 && !force)
             return false;
-        if (i == lineStart)
+        if (block == firstBlock)
             deleteFirst = len;
         deleteTotal += len;
-        stream << line.remove(line.indexOf(match), len);
-        if (i != lineEnd)
-#if QT_VERSION >= 0x50E00
-            stream << Qt::endl;
-#else
-            stream << endl;
-#endif
+        if (len > 0)
+            removals.append({block.position() + static_cast<int>(match.capturedStart(1)), len});
+        if (block == lastBlock)
+            break;
     }
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineStart);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, lineEnd - lineStart);
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    cursor.insertText(newText);
+
+    // Remove from the back, so earlier positions stay valid
+    cursor.beginEditBlock();
+    for (int i = removals.size() - 1; i >= 0; --i)
+    {
+        cursor.setPosition(removals.at(i).first);
+        cursor.setPosition(removals.at(i).first + removals.at(i).second, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        m_undoHistory->reportEdit(removals.at(i).first, removals.at(i).second, 0);
+    }
+    cursor.endEditBlock();
+
     cursor.setPosition(qMax(0, selectionStart - deleteFirst));
     if (cursor.blockNumber() < lineStart)
     {
@@ -1186,32 +2321,33 @@ bool QCodeEditor::removeInEachLineOfSelection(const QRegularExpression &regex, b
 void QCodeEditor::addInEachLineOfSelection(const QRegularExpression &regex, const QString &str)
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
-    QString newText;
-    QTextStream stream(&newText);
-    for (int i = lineStart; i <= lineEnd; ++i)
-    {
-        auto line = lines[i];
-        stream << line.insert(line.indexOf(regex), str);
-        if (i != lineEnd)
-#if QT_VERSION >= 0x50E00
-            stream << Qt::endl;
-#else
-            stream << endl;
-#endif
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
+    int lineStart = firstBlock.blockNumber();
+    int lineEnd = lastBlock.blockNumber();
+
+    QVector<int> insertions;
+    insertions.reserve(lineEnd - lineStart + 1);
+    for (auto block = firstBlock;; block = block.next())
+    {
+        insertions.append(block.position() + qMax(0, static_cast<int>(block.text().indexOf(regex))));
+        if (block == lastBlock)
+            break;
     }
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineStart);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, lineEnd - lineStart);
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    cursor.insertText(newText);
+
+    // Insert from the back, so earlier positions stay valid
+    cursor.beginEditBlock();
+    for (int i = insertions.size() - 1; i >= 0; --i)
+    {
+        cursor.setPosition(insertions.at(i));
+        cursor.insertText(str);
+        m_undoHistory->reportEdit(insertions.at(i), 0, cursor.position() - insertions.at(i));
+    }
+    cursor.endEditBlock();
+
     int pos = selectionStart + str.length();
     int pos2 = selectionEnd + str.length() * (lineEnd - lineStart + 1);
     if (cursorAtEnd)
@@ -1226,3 +2362,1212 @@ void QCodeEditor::addInEachLineOfSelection(const QRegularExpression &regex, cons
     }
     setTextCursor(cursor);
 }
+
+static bool cursorsOverlap(int lhsStart, int lhsEnd, int rhsStart, int rhsEnd)
+{
+    if (lhsStart == rhsStart)
+        return true;
+
+    return lhsStart < rhsEnd && rhsStart < lhsEnd;
+}
+
+static QTextCursor::MoveOperation moveOperationForKey(int key)
+{
+    switch (key)
+    {
+    case Qt::Key_Left:
+        return QTextCursor::Left;
+    case Qt::Key_Right:
+        return QTextCursor::Right;
+    case Qt::Key_Up:
+        return QTextCursor::Up;
+    case Qt::Key_Down:
+        return QTextCursor::Down;
+    case Qt::Key_Home:
+        return QTextCursor::StartOfLine;
+    case Qt::Key_End:
+        return QTextCursor::EndOfLine;
+    default:
+        return QTextCursor::NoMove;
+    }
+}
+
+bool QCodeEditor::proceedMultiCursorKey(QKeyEvent *e)
+{
+    static QRegularExpression RE_LINE_START_WHITESPACE("^\\s*");
+
+    auto modifiers = e->modifiers() & ~Qt::KeyboardModifiers(Qt::KeypadModifier);
+    auto moveMode = modifiers == Qt::ShiftModifier ? QTextCursor::KeepAnchor : QTextCursor::MoveAnchor;
+
+    // QTextEdit copies nothing, if the text cursor has no selection, even though other carets have one
+    if (e->matches(QKeySequence::Copy))
+    {
+        copyCursors();
+        return true;
+    }
+
+    // Paste goes through insertFromMimeData
+    if (e->matches(QKeySequence::Paste))
+        return false;
+
+    if (e->matches(QKeySequence::Cut))
+    {
+        copyCursors();
+        editCursors([](QTextCursor &cursor, int) { cursor.removeSelectedText(); });
+        return true;
+    }
+
+    switch (e->key())
+    {
+    case Qt::Key_Shift:
+    case Qt::Key_Control:
+    case Qt::Key_Alt:
+    case Qt::Key_Meta:
+        return false;
+    case Qt::Key_Escape:
+        clearExtraCursors();
+        return true;
+    case Qt::Key_Left:
+    case Qt::Key_Right:
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_Home:
+    case Qt::Key_End:
+        if (modifiers != Qt::NoModifier && modifiers != Qt::ShiftModifier)
+            break;
+        moveCursors(moveOperationForKey(e->key()), moveMode);
+        return true;
+    case Qt::Key_Backspace:
+        if (modifiers != Qt::NoModifier)
+            break;
+        editCursors([this](QTextCursor &cursor, int) {
+            if (cursor.hasSelection())
+            {
+                cursor.removeSelectedText();
+                return;
+            }
+
+            auto pre = document()->characterAt(cursor.position() - 1);
+            auto nxt = document()->characterAt(cursor.position());
+            for (auto &&p : qAsConst(m_parentheses))
+            {
+                if (p.autoRemove && p.left == pre && p.right == nxt)
+                {
+                    cursor.deleteChar();
+                    break;
+                }
+            }
+            cursor.deletePreviousChar();
+        });
+        return true;
+    case Qt::Key_Delete:
+        if (modifiers != Qt::NoModifier)
+            break;
+        editCursors([](QTextCursor &cursor, int) { cursor.deleteChar(); });
+        return true;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (modifiers != Qt::NoModifier)
+            break;
+        editCursors([this](QTextCursor &cursor, int) {
+            QString indentation;
+            if (m_autoIndentation)
+            {
+                indentation = RE_LINE_START_WHITESPACE.match(cursor.block().text()).captured();
+                indentation = indentation.left(cursor.positionInBlock());
+            }
+            cursor.insertText("\n" + indentation);
+        });
+        return true;
+    case Qt::Key_Tab:
+        if (modifiers != Qt::NoModifier)
+            break;
+        padBlockSelection();
+        editCursors([this](QTextCursor &cursor, int) { cursor.insertText(m_replaceTab ? m_tabReplace : "\t"); });
+        return true;
+    default:
+        break;
+    }
+
+    auto text = e->text();
+    auto isTyping = (modifiers & ~Qt::KeyboardModifiers(Qt::ShiftModifier)) == Qt::NoModifier;
+    if (isTyping && !text.isEmpty() && text.at(0).isPrint())
+    {
+        padBlockSelection();
+        editCursors([this, &text](QTextCursor &cursor, int) {
+            for (auto &&p : qAsConst(m_parentheses))
+            {
+                if (!p.autoComplete)
+                    continue;
+
+                if (cursor.hasSelection())
+                {
+                    if (p.left == text)
+                    {
+                        // Add parentheses for selection
+                        int startPos = cursor.selectionStart();
+                        int endPos = cursor.selectionEnd();
+                        cursor.insertText(p.left + cursor.selectedText() + p.right);
+                        cursor.setPosition(startPos + 1);
+                        cursor.setPosition(endPos + 1, QTextCursor::KeepAnchor);
+                        return;
+                    }
+                }
+                else
+                {
+                    if (p.right == text && document()->characterAt(cursor.position()) == p.right)
+                    {
+                        cursor.movePosition(QTextCursor::NextCharacter);
+                        return;
+                    }
+
+                    if (p.left == text)
+                    {
+                        cursor.insertText(QString(p.left) + p.right);
+                        cursor.movePosition(QTextCursor::PreviousCharacter);
+                        return;
+                    }
+                }
+            }
+
+            cursor.insertText(text);
+        });
+        return true;
+    }
+
+    // Anything else (undo, shortcuts, ...) works on the text cursor only
+    clearExtraCursors();
+    return false;
+}
+
+void QCodeEditor::editCursors(const std::function<void(QTextCursor &cursor, int index)> &edit)
+{
+    // The carets are kept, but they don't form a rectangle anymore
+    m_hasBlockSelection = false;
+
+    auto primary = textCursor();
+    auto carets = m_extraCursors;
+    carets.append({primary.anchor(), primary.position()});
+
+    // The primary caret stays last, the carets are visited in document order
+    QVector<int> order(carets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&carets](int lhs, int rhs) { return carets.at(lhs).start() < carets.at(rhs).start(); });
+
+    // A single cursor visits the carets in document order, each one is moved by the edits before it.
+    // All edits share one edit block, so there's a single contentsChange for layout and highlighting.
+    // The undo history gets the edit of each caret instead of the range from the first to the last one.
+    QTextCursor cursor(document());
+    int offset = 0;
+
+    m_editingCursors = true;
+    cursor.beginEditBlock();
+    for (int i = 0; i < order.size(); ++i)
+    {
+        auto &caret = carets[order.at(i)];
+        auto length = document()->characterCount();
+
+        cursor.setPosition(caret.anchor + offset);
+        cursor.setPosition(caret.position + offset, QTextCursor::KeepAnchor);
+        auto firstBlock = document()->findBlock(qMax(0, cursor.selectionStart() - 1));
+        auto lastBlock = document()->findBlock(cursor.selectionEnd());
+        auto from = firstBlock.position();
+        auto to = qMin(lastBlock.position() + lastBlock.length(), length - 1);
+        edit(cursor, i);
+
+        auto delta = document()->characterCount() - length;
+        m_undoHistory->reportEdit(from, to - from, to - from + delta);
+
+        caret = {cursor.anchor(), cursor.position()};
+        offset += delta;
+    }
+    cursor.endEditBlock();
+    m_editingCursors = false;
+
+    auto primaryIndex = static_cast<int>(carets.size()) - 1;
+    primary.setPosition(carets.at(primaryIndex).anchor);
+    primary.setPosition(carets.at(primaryIndex).position, QTextCursor::KeepAnchor);
+    carets.remove(primaryIndex);
+    m_extraCursors = carets;
+
+    setTextCursor(primary);
+    mergeCursors();
+    viewport()->update();
+}
+
+void QCodeEditor::moveCursors(QTextCursor::MoveOperation operation, QTextCursor::MoveMode mode)
+{
+    m_hasBlockSelection = false;
+
+    auto primary = textCursor();
+    primary.movePosition(operation, mode);
+
+    QTextCursor cursor(document());
+    for (auto &caret : m_extraCursors)
+    {
+        cursor.setPosition(caret.anchor);
+        cursor.setPosition(caret.position, QTextCursor::KeepAnchor);
+        cursor.movePosition(operation, mode);
+        caret = {cursor.anchor(), cursor.position()};
+    }
+
+    setTextCursor(primary);
+    mergeCursors();
+    viewport()->update();
+}
+
+void QCodeEditor::mergeCursors()
+{
+    if (m_extraCursors.isEmpty())
+        return;
+
+    auto primary = textCursor();
+
+    std::sort(m_extraCursors.begin(), m_extraCursors.end(),
+              [](const Caret &lhs, const Caret &rhs) { return lhs.start() < rhs.start(); });
+
+    QVector<Caret> merged;
+    merged.reserve(m_extraCursors.size());
+    for (auto &&caret : qAsConst(m_extraCursors))
+    {
+        if (cursorsOverlap(caret.start(), caret.end(), primary.selectionStart(), primary.selectionEnd()))
+            continue;
+
+        if (!merged.isEmpty() && cursorsOverlap(merged.last().start(), merged.last().end(), caret.start(), caret.end()))
+            continue;
+
+        merged.append(caret);
+    }
+
+    m_extraCursors = merged;
+}
+
+void QCodeEditor::shiftCursors(int position, int charsRemoved, int charsAdded)
+{
+    if (m_editingCursors || m_changingVisibility || m_extraCursors.isEmpty())
+        return;
+
+    // The carets are sorted and don't overlap, so the ones before the edit are skipped by a binary search
+    auto it = std::lower_bound(m_extraCursors.begin(), m_extraCursors.end(), position,
+                               [](const Caret &caret, int value) { return caret.end() < value; });
+
+    auto delta = charsAdded - charsRemoved;
+    auto shift = [position, charsRemoved, charsAdded, delta](int value) {
+        if (value >= position + charsRemoved)
+            return value + delta;
+
+        return value > position ? qMin(value, position + charsAdded) : value;
+    };
+
+    for (; it != m_extraCursors.end(); ++it)
+        *it = {shift(it->anchor), shift(it->position)};
+}
+
+void QCodeEditor::paintTextRange(QPainter &painter, int start, int end, const QBrush &brush)
+{
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+
+    for (auto block = document()->findBlock(start); block.isValid() && block.position() <= end; block = block.next())
+    {
+        auto layout = block.layout();
+        if (!block.isVisible() || layout == nullptr)
+            continue;
+
+        auto origin = layout->position() + offset;
+        for (int i = 0; i < layout->lineCount(); ++i)
+        {
+            auto line = layout->lineAt(i);
+            int lineStart = block.position() + line.textStart();
+            int from = qMax(start, lineStart);
+            int to = qMin(end, lineStart + line.textLength());
+
+            if (from >= to)
+                continue;
+
+            auto x1 = line.cursorToX(from - block.position());
+            auto x2 = line.cursorToX(to - block.position());
+            painter.fillRect(QRectF(origin.x() + x1, origin.y() + line.y(), x2 - x1, line.height()), brush);
+        }
+    }
+}
+
+void QCodeEditor::paintExtraCursors(QPainter &painter, bool caret)
+{
+    if (!caret && m_hasBlockSelection)
+    {
+        paintBlockSelection(painter);
+        return;
+    }
+
+    if (m_extraCursors.isEmpty())
+        return;
+
+    // Only carets within the viewport are painted, the list is sorted
+    // and non overlapping, so it can be searched by position
+    int firstVisible = cursorForPosition(QPoint(0, 0)).position();
+    int lastVisible = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+
+    auto it = std::lower_bound(m_extraCursors.cbegin(), m_extraCursors.cend(), firstVisible,
+                               [](const Caret &caret, int position) { return caret.end() < position; });
+
+    auto selectionBrush = m_syntaxStyle->getFormat("Selection").background();
+    auto caretColor = m_syntaxStyle->getFormat("Text").foreground().color();
+
+    QTextCursor cursor(document());
+    for (; it != m_extraCursors.cend() && it->start() <= lastVisible; ++it)
+    {
+        if (caret)
+        {
+            cursor.setPosition(it->position);
+            auto rect = cursorRect(cursor);
+            painter.fillRect(QRect(rect.left(), rect.top(), cursorWidth(), rect.height()), caretColor);
+        }
+        else if (it->anchor != it->position)
+        {
+            paintTextRange(painter, it->start(), it->end(), selectionBrush);
+        }
+    }
+}
+
+static qreal spaceWidth(const QFontMetrics &metrics)
+{
+#if QT_VERSION >= 0x050B00
+    return metrics.horizontalAdvance(QString(1000, ' ')) / 1000.0;
+#else
+    return metrics.width(QString(1000, ' ')) / 1000.0;
+#endif
+}
+
+static int visualColumnOf(const QString &text, int position, int tabSize)
+{
+    int column = 0;
+    for (int i = 0; i < position && i < text.length(); ++i)
+        column = text.at(i) == '\t' ? (column / tabSize + 1) * tabSize : column + 1;
+
+    return column;
+}
+
+static int positionOfVisualColumn(const QString &text, int column, int tabSize)
+{
+    int current = 0;
+    for (int i = 0; i < text.length(); ++i)
+    {
+        int next = text.at(i) == '\t' ? (current / tabSize + 1) * tabSize : current + 1;
+        if (next > column)
+            return column - current <= next - column ? i : i + 1;
+        current = next;
+    }
+
+    return static_cast<int>(text.length());
+}
+
+bool QCodeEditor::proceedBlockSelectionKey(QKeyEvent *e)
+{
+    if (e->modifiers() != (Qt::AltModifier | Qt::ShiftModifier))
+        return false;
+
+    if (!m_hasBlockSelection)
+    {
+        auto cursor = textCursor();
+        auto tabSize = qMax(1, tabReplaceSize());
+        auto column = visualColumnOf(cursor.block().text(), cursor.positionInBlock(), tabSize);
+        m_blockSelection = {cursor.blockNumber(), column, cursor.blockNumber(), column};
+    }
+
+    auto line = m_blockSelection.line;
+    auto column = m_blockSelection.column;
+
+    switch (e->key())
+    {
+    case Qt::Key_Up:
+        --line;
+        break;
+    case Qt::Key_Down:
+        ++line;
+        break;
+    case Qt::Key_Left:
+        --column;
+        break;
+    case Qt::Key_Right:
+        ++column;
+        break;
+    default:
+        return false;
+    }
+
+    setBlockSelection(m_blockSelection.anchorLine, m_blockSelection.anchorColumn, line, column);
+    return true;
+}
+
+int QCodeEditor::visualColumnAt(const QPoint &pos) const
+{
+    auto block = cursorForPosition(pos).block();
+    auto layout = block.layout();
+    qreal x = pos.x() + horizontalScrollBar()->value();
+    if (layout)
+        x -= layout->position().x();
+
+    return qMax(0, qRound(x / spaceWidth(fontMetrics())));
+}
+
+void QCodeEditor::updateBlockSelection()
+{
+    auto tabSize = qMax(1, tabReplaceSize());
+    auto firstLine = qMin(m_blockSelection.anchorLine, m_blockSelection.line);
+    auto lastLine = qMax(m_blockSelection.anchorLine, m_blockSelection.line);
+    auto anchorAtLeft = m_blockSelection.anchorColumn <= m_blockSelection.column;
+
+    m_extraCursors.clear();
+    m_extraCursors.reserve(lastLine - firstLine + 1);
+
+    QTextCursor primary;
+    auto block = document()->findBlockByNumber(firstLine);
+    for (int line = firstLine; line <= lastLine && block.isValid(); ++line, block = block.next())
+    {
+        auto text = block.text();
+        auto anchor = block.position() + positionOfVisualColumn(text, m_blockSelection.anchorColumn, tabSize);
+        auto position = block.position() + positionOfVisualColumn(text, m_blockSelection.column, tabSize);
+
+        Caret caret{anchorAtLeft ? qMin(anchor, position) : qMax(anchor, position),
+                    anchorAtLeft ? qMax(anchor, position) : qMin(anchor, position)};
+
+        if (line == m_blockSelection.line)
+        {
+            primary = QTextCursor(document());
+            primary.setPosition(caret.anchor);
+            primary.setPosition(caret.position, QTextCursor::KeepAnchor);
+        }
+        else
+        {
+            m_extraCursors.append(caret);
+        }
+    }
+
+    setTextCursor(primary);
+
+    viewport()->update();
+}
+
+void QCodeEditor::padBlockSelection()
+{
+    if (!m_hasBlockSelection)
+        return;
+
+    auto tabSize = qMax(1, tabReplaceSize());
+    auto left = qMin(m_blockSelection.anchorColumn, m_blockSelection.column);
+    auto firstLine = qMin(m_blockSelection.anchorLine, m_blockSelection.line);
+    auto lastLine = qMax(m_blockSelection.anchorLine, m_blockSelection.line);
+
+    QTextCursor cursor(document());
+    auto padded = false;
+
+    auto block = document()->findBlockByNumber(firstLine);
+    for (int line = firstLine; line <= lastLine && block.isValid(); ++line, block = block.next())
+    {
+        auto text = block.text();
+        auto width = visualColumnOf(text, static_cast<int>(text.length()), tabSize);
+        if (width >= left)
+            continue;
+
+        if (!padded)
+            cursor.beginEditBlock();
+        padded = true;
+
+        cursor.setPosition(block.position() + static_cast<int>(text.length()));
+        cursor.insertText(QString(left - width, ' '));
+        m_undoHistory->reportEdit(cursor.position() - (left - width), 0, left - width);
+    }
+
+    if (!padded)
+        return;
+
+    cursor.endEditBlock();
+
+    // The carets of the padded lines now start at the left column
+    updateBlockSelection();
+}
+
+void QCodeEditor::copyCursors()
+{
+    QGuiApplication::clipboard()->setMimeData(createMimeDataFromSelection());
+}
+
+void QCodeEditor::paintBlockSelection(QPainter &painter)
+{
+    auto charWidth = spaceWidth(fontMetrics());
+    auto firstLine = qMin(m_blockSelection.anchorLine, m_blockSelection.line);
+    auto lastLine = qMax(m_blockSelection.anchorLine, m_blockSelection.line);
+    auto left = qMin(m_blockSelection.anchorColumn, m_blockSelection.column) * charWidth;
+    auto right = qMax(m_blockSelection.anchorColumn, m_blockSelection.column) * charWidth;
+    auto brush = m_syntaxStyle->getFormat("Selection").background();
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+
+    // Start at the first visible line, instead of the top of the rectangle
+    auto block = cursorForPosition(QPoint(0, 0)).block();
+    if (block.blockNumber() < firstLine)
+        block = document()->findBlockByNumber(firstLine);
+
+    for (; block.isValid() && block.blockNumber() <= lastLine; block = block.next())
+    {
+        auto layout = block.layout();
+        if (!block.isVisible() || layout == nullptr || layout->lineCount() == 0)
+            continue;
+
+        auto origin = layout->position() + offset;
+        if (origin.y() > viewport()->height())
+            break;
+
+        auto line = layout->lineAt(0);
+        painter.fillRect(QRectF(origin.x() + left, origin.y() + line.y(), qMax<qreal>(right - left, 1), line.height()),
+                         brush);
+    }
+}
+
+bool QCodeEditor::isFoldable(int line) const
+{
+    auto block = document()->findBlockByNumber(line);
+    if (!block.isValid())
+        return false;
+
+    if (foldingStyle() == QStyleSyntaxHighlighter::FoldingStyle::Indentation)
+    {
+        auto indentation = QIndentationEngine::indentationOf(block.text(), tabReplaceSize());
+        if (indentation < 0)
+            return false;
+
+        for (block = block.next(); block.isValid(); block = block.next())
+        {
+            auto nextIndentation = QIndentationEngine::indentationOf(block.text(), tabReplaceSize());
+            if (nextIndentation >= 0)
+                return nextIndentation > indentation;
+        }
+
+        return false;
+    }
+
+    auto data = QCodeBlockData::get(block);
+    return data != nullptr &&
+           std::any_of(data->bracketSummaries.cbegin(), data->bracketSummaries.cend(),
+                       [](const QCodeBlockData::BracketSummary &summary) { return summary.unmatchedOpens > 0; });
+}
+
+bool QCodeEditor::isFolded(int line) const
+{
+    return foldIndex(document()->findBlockByNumber(line)) >= 0;
+}
+
+int QCodeEditor::lastFoldedLine(int line) const
+{
+    auto index = foldIndex(document()->findBlockByNumber(line));
+    return index < 0 ? -1 : m_folds.at(index).end.blockNumber();
+}
+
+void QCodeEditor::setFolded(int line, bool folded)
+{
+    auto block = document()->findBlockByNumber(line);
+    auto index = foldIndex(block);
+    if (!block.isValid() || folded == (index >= 0))
+        return;
+
+    if (!folded)
+    {
+        auto last = m_folds.at(index).end.blockNumber();
+        m_folds.remove(index);
+        indexFolds();
+        setLinesVisible(line + 1, last, true);
+        return;
+    }
+
+    auto last = foldEnd(block);
+    if (last < 0)
+        return;
+
+    // Both cursors stay at the end of their line, when text is typed there
+    FoldRegion region{QTextCursor(block), QTextCursor(document()->findBlockByNumber(last))};
+    for (auto cursor : {&region.start, &region.end})
+    {
+        cursor->movePosition(QTextCursor::EndOfBlock);
+        cursor->setKeepPositionOnInsert(true);
+    }
+
+    auto it = std::lower_bound(m_folds.begin(), m_folds.end(), region.start.position(),
+                               [](const FoldRegion &fold, int value) { return fold.start.position() < value; });
+    m_folds.insert(it, region);
+    indexFolds();
+
+    setLinesVisible(line + 1, last, false);
+
+    // The caret must not stay in a hidden line
+    auto cursor = textCursor();
+    if (cursor.blockNumber() > line && cursor.blockNumber() <= last)
+    {
+        cursor.setPosition(region.start.position());
+        setTextCursor(cursor);
+    }
+}
+
+void QCodeEditor::toggleFold(int line)
+{
+    setFolded(line, !isFolded(line));
+}
+
+void QCodeEditor::unfoldAll()
+{
+    if (m_folds.isEmpty())
+        return;
+
+    auto firstLine = m_folds.first().start.blockNumber() + 1;
+    auto lastLine = firstLine;
+    for (auto &&fold : qAsConst(m_folds))
+        lastLine = qMax(lastLine, fold.end.blockNumber());
+
+    m_folds.clear();
+    indexFolds();
+    setLinesVisible(firstLine, lastLine, true);
+}
+
+QStyleSyntaxHighlighter::FoldingStyle QCodeEditor::foldingStyle() const
+{
+    return m_highlighter ? m_highlighter->foldingStyle() : QStyleSyntaxHighlighter::FoldingStyle::Indentation;
+}
+
+int QCodeEditor::foldEnd(const QTextBlock &block) const
+{
+    if (foldingStyle() == QStyleSyntaxHighlighter::FoldingStyle::Indentation)
+    {
+        auto indentation = QIndentationEngine::indentationOf(block.text(), tabReplaceSize());
+        if (indentation < 0)
+            return -1;
+
+        // Blank lines belong to the region only if it goes on after them
+        int last = -1;
+        int line = block.blockNumber();
+        for (auto next = block.next(); next.isValid(); next = next.next())
+        {
+            ++line;
+            auto nextIndentation = QIndentationEngine::indentationOf(next.text(), tabReplaceSize());
+            if (nextIndentation < 0)
+                continue;
+
+            if (nextIndentation <= indentation)
+                break;
+
+            last = line;
+        }
+
+        return last;
+    }
+
+    auto data = QCodeBlockData::get(block);
+    if (data == nullptr)
+        return -1;
+
+    // The region starts at the last bracket, that isn't closed in the block, e.g. the one of "} else {"
+    const auto &summaries = data->bracketSummaries;
+    QVector<int> closes(summaries.size(), 0);
+    for (auto it = data->brackets.crbegin(); it != data->brackets.crend(); ++it)
+    {
+        for (int i = 0; i < summaries.size(); ++i)
+        {
+            if (it->character == summaries.at(i).close)
+            {
+                ++closes[i];
+            }
+            else if (it->character == summaries.at(i).open)
+            {
+                if (closes[i] > 0)
+                {
+                    --closes[i];
+                    continue;
+                }
+
+                auto match = matchingParenthesis(block.position() + it->position);
+                if (match < 0)
+                    return -1;
+
+                auto last = document()->findBlock(match).blockNumber() - 1;
+                return last > block.blockNumber() ? last : -1;
+            }
+        }
+    }
+
+    return -1;
+}
+
+int QCodeEditor::foldIndex(const QTextBlock &block) const
+{
+    if (!block.isValid())
+        return -1;
+
+    auto it = std::lower_bound(m_folds.cbegin(), m_folds.cend(), block.position(),
+                               [](const FoldRegion &fold, int value) { return fold.start.position() < value; });
+    if (it == m_folds.cend() || it->start.block() != block)
+        return -1;
+
+    return static_cast<int>(it - m_folds.cbegin());
+}
+
+void QCodeEditor::setLinesVisible(int firstLine, int lastLine, bool visible)
+{
+    auto block = document()->findBlockByNumber(firstLine);
+    if (!block.isValid() || lastLine < firstLine)
+        return;
+
+    auto from = block.position();
+    auto to = from;
+    for (int line = firstLine; block.isValid() && line <= lastLine; block = block.next(), ++line)
+    {
+        block.setVisible(visible);
+        to = block.position() + block.length();
+
+        // Regions folded inside of the shown one stay hidden
+        auto index = visible ? foldIndex(block) : -1;
+        if (index >= 0)
+        {
+            block = m_folds.at(index).end.block();
+            line = block.blockNumber();
+            to = block.position() + block.length();
+        }
+    }
+
+    // The text didn't change, so only the layout is told about it
+    m_changingVisibility = true;
+    document()->markContentsDirty(from, to - from);
+    m_changingVisibility = false;
+
+    m_lineNumberArea->update();
+    viewport()->update();
+}
+
+void QCodeEditor::updateFolds(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    // A fold reaches to the line after its region. Folds before the first one, that reaches the edit, end before it.
+    auto reach = [this](int index) {
+        auto end = m_folds.at(m_foldMaximumEnds.at(index)).end.block();
+        return end.position() + end.length();
+    };
+
+    auto count = static_cast<int>(m_folds.size());
+    auto first = firstIndex(count, [&reach, position](int i) { return reach(i) < position; });
+
+    auto changed = false;
+
+    // Folds are sorted by start, the ones after the edit keep their region
+    for (int i = first; i < m_folds.size() && position + charsAdded >= m_folds.at(i).start.block().position();)
+    {
+        auto start = m_folds.at(i).start.block();
+        auto end = m_folds.at(i).end.block();
+        auto line = start.blockNumber();
+        auto last = end.blockNumber();
+
+        if (position > end.position() + end.length())
+        {
+            ++i;
+            continue;
+        }
+
+        // A fold, whose lines were removed or merged with another fold, is dropped
+        auto collapsed = last <= line || (i > 0 && m_folds.at(i - 1).start.block() == start);
+        auto newLast = collapsed ? -1 : foldEnd(start);
+        if (newLast < 0)
+        {
+            m_folds.remove(i);
+            changed = true;
+            setLinesVisible(line + 1, last, true);
+            continue;
+        }
+
+        // Lines inserted after the first one of the fold have to be hidden as well
+        if (newLast != last || position + charsAdded > start.position() + start.length())
+        {
+            setLinesVisible(line + 1, last, true);
+            m_folds[i].end = QTextCursor(document()->findBlockByNumber(newLast));
+            m_folds[i].end.movePosition(QTextCursor::EndOfBlock);
+            m_folds[i].end.setKeepPositionOnInsert(true);
+            changed = true;
+            setLinesVisible(line + 1, newLast, false);
+        }
+
+        ++i;
+    }
+
+    if (changed)
+        indexFolds();
+}
+
+void QCodeEditor::indexFolds()
+{
+    m_foldMaximumEnds.resize(m_folds.size());
+
+    int maximum = -1;
+    for (int i = 0; i < m_folds.size(); ++i)
+    {
+        if (maximum < 0 || m_folds.at(i).end.position() > m_folds.at(maximum).end.position())
+            maximum = i;
+
+        m_foldMaximumEnds[i] = maximum;
+    }
+}
+
+void QCodeEditor::indexDecorations(DecorationLayer &layer)
+{
+    layer.maximumEnds.resize(layer.decorations.size());
+
+    int maximumEnd = -1;
+    for (int i = 0; i < layer.decorations.size(); ++i)
+    {
+        const auto &decoration = layer.decorations.at(i);
+        maximumEnd = qMax(maximumEnd, qMax(decoration.start, decoration.end));
+        layer.maximumEnds[i] = maximumEnd;
+    }
+
+    layer.shiftFrom = static_cast<int>(layer.decorations.size());
+    layer.shift = 0;
+}
+
+QCodeEditor::Decoration QCodeEditor::decorationAt(const DecorationLayer &layer, int index)
+{
+    auto decoration = layer.decorations.at(index);
+    if (index >= layer.shiftFrom)
+    {
+        decoration.start += layer.shift;
+        decoration.end += layer.shift;
+    }
+
+    return decoration;
+}
+
+int QCodeEditor::maximumEndAt(const DecorationLayer &layer, int index)
+{
+    return layer.maximumEnds.at(index) + (index >= layer.shiftFrom ? layer.shift : 0);
+}
+
+void QCodeEditor::settleDecorations(DecorationLayer &layer, int index)
+{
+    auto from = qMin(index, layer.shiftFrom);
+    auto to = qMax(index, layer.shiftFrom);
+    auto shift = index > layer.shiftFrom ? layer.shift : -layer.shift;
+
+    for (int i = from; i < to && shift != 0; ++i)
+    {
+        layer.decorations[i].start += shift;
+        layer.decorations[i].end += shift;
+        layer.maximumEnds[i] += shift;
+    }
+
+    layer.shiftFrom = index;
+}
+
+QVector<QCodeEditor::Decoration> QCodeEditor::decorationsInRange(const DecorationLayer &layer, int from, int to)
+{
+    QVector<Decoration> result;
+
+    // Decorations before the first one, whose maximum end reaches the range, end before it
+    auto first = firstIndex(static_cast<int>(layer.maximumEnds.size()),
+                            [&layer, from](int i) { return maximumEndAt(layer, i) < from; });
+    for (auto i = first; i < layer.decorations.size(); ++i)
+    {
+        auto decoration = decorationAt(layer, i);
+        if (decoration.start > to)
+            break;
+
+        if (qMax(decoration.start, decoration.end) >= from)
+            result.append(decoration);
+    }
+
+    return result;
+}
+
+void QCodeEditor::updateDecorations(const DecorationLayer &layer)
+{
+    if (layer.decorations.isEmpty())
+        return;
+
+    auto firstBlock = cursorForPosition(QPoint(0, 0)).block();
+    auto lastBlock = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).block();
+    auto documentLayout = document()->documentLayout();
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+
+    auto to = lastBlock.position() + lastBlock.length();
+
+    for (auto &&decoration : decorationsInRange(layer, firstBlock.position(), to))
+    {
+        auto rect = documentLayout->blockBoundingRect(document()->findBlock(decoration.start))
+                        .united(documentLayout->blockBoundingRect(document()->findBlock(decoration.end)))
+                        .translated(offset);
+
+        viewport()->update(QRect(0, qFloor(rect.top()), viewport()->width(), qCeil(rect.height()) + 1));
+    }
+}
+
+void QCodeEditor::paintDecorations(QPainter &painter)
+{
+    if (m_decorationLayers.isEmpty())
+        return;
+
+    QVector<const DecorationLayer *> layers;
+    for (auto it = m_decorationLayers.cbegin(); it != m_decorationLayers.cend(); ++it)
+        layers.append(&it.value());
+
+    std::stable_sort(layers.begin(), layers.end(),
+                     [](const DecorationLayer *lhs, const DecorationLayer *rhs) { return lhs->z < rhs->z; });
+
+    auto firstBlock = cursorForPosition(QPoint(0, 0)).block();
+    auto lastBlock = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).block();
+    auto to = lastBlock.position() + lastBlock.length();
+
+    for (auto &&layer : layers)
+    {
+        for (auto &&decoration : decorationsInRange(*layer, firstBlock.position(), to))
+        {
+            paintDecoration(painter, decoration);
+        }
+    }
+}
+
+void QCodeEditor::paintDecoration(QPainter &painter, const Decoration &decoration)
+{
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+    auto fullWidth = decoration.format.boolProperty(QTextFormat::FullWidthSelection);
+    auto background = decoration.format.background();
+    auto underlineStyle = decoration.format.underlineStyle();
+    auto start = qMin(decoration.start, decoration.end);
+    auto end = qMax(decoration.start, decoration.end);
+
+    for (auto block = document()->findBlock(start); block.isValid() && block.position() <= end; block = block.next())
+    {
+        auto layout = block.layout();
+        if (!block.isVisible() || layout == nullptr)
+            continue;
+
+        auto origin = layout->position() + offset;
+        for (int i = 0; i < layout->lineCount(); ++i)
+        {
+            auto line = layout->lineAt(i);
+            int lineStart = block.position() + line.textStart();
+            int lineEnd = lineStart + line.textLength();
+            auto top = origin.y() + line.y();
+
+            if (fullWidth)
+            {
+                // Lines are closed ranges here, so an empty decoration covers its line
+                if (start <= lineEnd && end >= lineStart)
+                    painter.fillRect(QRectF(0, top, viewport()->width(), line.height()), background);
+
+                continue;
+            }
+
+            int from = qMax(start, lineStart);
+            int to = qMin(end, lineEnd);
+            if (from >= to)
+                continue;
+
+            auto x1 = origin.x() + line.cursorToX(from - block.position());
+            auto x2 = origin.x() + line.cursorToX(to - block.position());
+
+            if (background.style() != Qt::NoBrush)
+                painter.fillRect(QRectF(x1, top, x2 - x1, line.height()), background);
+
+            if (underlineStyle == QTextCharFormat::NoUnderline)
+                continue;
+
+            auto color = decoration.format.underlineColor();
+            QPen pen(color.isValid() ? color : decoration.format.foreground().color());
+            auto y = top + line.ascent() + 1.5;
+
+            if (underlineStyle == QTextCharFormat::WaveUnderline ||
+                underlineStyle == QTextCharFormat::SpellCheckUnderline)
+            {
+                QPainterPath wave(QPointF(x1, y));
+                auto amplitude = qMax<qreal>(1, line.descent() / 3);
+                auto up = true;
+                for (auto x = x1 + amplitude * 2; x < x2 + amplitude * 2; x += amplitude * 2, up = !up)
+                    wave.lineTo(qMin(x, x2), y + (up ? -amplitude : amplitude));
+
+                painter.save();
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.strokePath(wave, pen);
+                painter.restore();
+                continue;
+            }
+
+            switch (underlineStyle)
+            {
+            case QTextCharFormat::DashUnderline:
+                pen.setStyle(Qt::DashLine);
+                break;
+            case QTextCharFormat::DotLine:
+                pen.setStyle(Qt::DotLine);
+                break;
+            case QTextCharFormat::DashDotLine:
+                pen.setStyle(Qt::DashDotLine);
+                break;
+            case QTextCharFormat::DashDotDotLine:
+                pen.setStyle(Qt::DashDotDotLine);
+                break;
+            default:
+                break;
+            }
+
+            painter.setPen(pen);
+            painter.drawLine(QPointF(x1, y), QPointF(x2, y));
+        }
+    }
+}
+
+void QCodeEditor::shiftDecorations(int position, int charsRemoved, int charsAdded)
+{
+    auto delta = charsAdded - charsRemoved;
+    auto shift = [position, charsRemoved, delta](int value) {
+        if (value < position)
+            return value;
+
+        // Positions in the removed text collapse to the start of the edit
+        return value >= position + charsRemoved ? value + delta : position;
+    };
+
+    for (auto &&layer : m_decorationLayers)
+    {
+        auto size = static_cast<int>(layer.decorations.size());
+
+        // Decorations, that start after the removed text, only move, they take the shift lazily
+        auto end = position + charsRemoved;
+        auto moved = firstIndex(size, [&layer, end](int i) { return decorationAt(layer, i).start < end; });
+        settleDecorations(layer, moved);
+        layer.shift += delta;
+
+        // Decorations before them, that reach into the edit, are shifted right away, the order is kept
+        auto first = firstIndex(moved, [&layer, position](int i) { return layer.maximumEnds.at(i) < position; });
+        for (int i = first; i < moved; ++i)
+        {
+            auto &decoration = layer.decorations[i];
+            decoration.start = shift(decoration.start);
+            decoration.end = shift(decoration.end);
+            layer.maximumEnds[i] = shift(layer.maximumEnds.at(i));
+        }
+    }
+}
+
+const QIndentationEngine *QCodeEditor::indentationEngine() const
+{
+    static QIndentationEngine defaultEngine;
+
+    if (m_highlighter && m_highlighter->indentationEngine())
+        return m_highlighter->indentationEngine().data();
+
+    return &defaultEngine;
+}
+
+QString QCodeEditor::indentationString(int columns) const
+{
+    if (m_replaceTab)
+        return QString(columns, ' ');
+
+    auto tabSize = qMax(1, tabReplaceSize());
+    return QString(columns / tabSize, '\t') + QString(columns % tabSize, ' ');
+}
+
+void QCodeEditor::setLineIndentation(QTextCursor &cursor, const QTextBlock &block, int columns)
+{
+    auto text = block.text();
+    int length = 0;
+    while (length < text.length() && text.at(length).isSpace())
+        ++length;
+
+    auto indentation = indentationString(columns);
+    cursor.setPosition(block.position());
+    cursor.setPosition(block.position() + length, QTextCursor::KeepAnchor);
+    cursor.insertText(indentation);
+    m_undoHistory->reportEdit(block.position(), length, static_cast<int>(indentation.size()));
+
+    // The edit block holds the highlighter back, but the following lines are measured with the data of this one
+    if (m_highlighter)
+        m_highlighter->rehighlightBlock(block);
+}
+
+void QCodeEditor::reindentLines(int firstLine, int lastLine, bool joinPreviousEdit)
+{
+    auto engine = indentationEngine();
+    auto tabSize = qMax(1, tabReplaceSize());
+
+    QTextCursor cursor(document());
+    if (joinPreviousEdit)
+        cursor.joinPreviousEditBlock();
+    else
+        cursor.beginEditBlock();
+
+    // Lines, the engine leaves alone, and lines of significant indentation move along with the line before
+    int shift = 0;
+    bool placed = false;
+
+    for (auto block = document()->findBlockByNumber(firstLine); block.isValid() && block.blockNumber() <= lastLine;
+         block = block.next())
+    {
+        auto current = QIndentationEngine::indentationOf(block.text(), tabSize);
+        if (current < 0)
+            continue;
+
+        auto wanted = -1;
+        if (!placed || !engine->isIndentationSignificant())
+            wanted = engine->indentation(block, tabSize);
+
+        if (wanted >= 0)
+        {
+            shift = wanted - current;
+            placed = true;
+        }
+        else
+        {
+            wanted = qMax(0, current + shift);
+        }
+
+        if (wanted != current)
+            setLineIndentation(cursor, block, wanted);
+    }
+
+    cursor.endEditBlock();
+}
+
+void QCodeEditor::insertIndentedLineBreak()
+{
+    // Have Qt Creator like behaviour, if {|} and enter is pressed the closing brace gets a line of its own
+    auto betweenBraces = charUnderCursor(-1) == '{' && charUnderCursor() == '}';
+
+    // The line break is inserted on its own, so the highlighter updates the block data, that the engine reads
+    insertPlainText(betweenBraces ? "\n\n" : "\n");
+
+    auto engine = indentationEngine();
+    auto tabSize = qMax(1, tabReplaceSize());
+    auto last = textCursor().block();
+    auto first = betweenBraces ? last.previous() : last;
+
+    // Lines, the engine leaves alone, e.g. in comments, keep the indentation of the line before
+    auto previousIndentation = qMax(0, QIndentationEngine::indentationOf(first.previous().text(), tabSize));
+
+    QVector<QPair<QTextBlock, int>> indentations;
+    for (auto block = first;; block = block.next())
+    {
+        auto indentation = engine->indentation(block, tabSize);
+        indentations.append({block, indentation < 0 ? previousIndentation : indentation});
+
+        if (block == last)
+            break;
+    }
+
+    auto cursor = textCursor();
+    cursor.joinPreviousEditBlock();
+    for (auto &&indentation : indentations)
+        setLineIndentation(cursor, indentation.first, indentation.second);
+    cursor.endEditBlock();
+
+    if (betweenBraces)
+    {
+        moveCursor(QTextCursor::PreviousBlock);
+        moveCursor(QTextCursor::EndOfBlock);
+    }
+
+    setTextCursor(textCursor()); // scroll to the cursor
+}
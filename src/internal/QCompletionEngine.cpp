@@ -0,0 +1,108 @@
+// QCodeEditor
+#include <internal/QCompletionEngine.hpp>
+
+// Qt
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+QCompletionEngine::QCompletionEngine(QObject *parent)
+    : QObject(parent), m_requests(), m_generation(0), m_running(false), m_count(0), m_snippets()
+{
+}
+
+QCompletionEngine::~QCompletionEngine()
+{
+    // Cancelled requests may still run until the provider checks
+    ++m_generation;
+    for (auto &request : m_requests)
+    {
+        request.waitForFinished();
+    }
+}
+
+void QCompletionEngine::request(const QSharedPointer<QCompletionProvider> &provider,
+                                const QCompletionProvider::Context &context)
+{
+    auto generation = ++m_generation;
+    m_running = true;
+    m_count = 0;
+
+    m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(),
+                                    [](const QFuture<void> &request) { return request.isFinished(); }),
+                     m_requests.end());
+
+    m_requests.append(QtConcurrent::run([this, provider, context, generation] {
+        auto deliver = [this, generation](const QStringList &completions, const QVector<QSnippet> &snippets,
+                                          bool last) {
+            QMetaObject::invokeMethod(
+                this, [this, generation, completions, snippets, last] {
+                    addCompletions(generation, completions, snippets, last);
+                },
+                Qt::QueuedConnection);
+        };
+
+        QCompletionProvider::Request request(
+            [this, generation] { return m_generation.load() != generation; },
+            [deliver](const QStringList &completions) { deliver(completions, QVector<QSnippet>(), false); },
+            [deliver](const QVector<QSnippet> &snippets) { deliver(QStringList(), snippets, false); });
+
+        provider->complete(context, request);
+
+        deliver(QStringList(), QVector<QSnippet>(), true);
+    }));
+}
+
+void QCompletionEngine::cancel()
+{
+    ++m_generation;
+    m_running = false;
+}
+
+bool QCompletionEngine::isRunning() const
+{
+    return m_running;
+}
+
+QSnippet QCompletionEngine::snippet(const QString &completion) const
+{
+    return m_snippets.value(completion);
+}
+
+void QCompletionEngine::addCompletions(int generation, const QStringList &completions,
+                                       const QVector<QSnippet> &snippets, bool last)
+{
+    if (generation != m_generation.load())
+    {
+        return;
+    }
+
+    auto labels = completions;
+    for (auto &&snippet : snippets)
+    {
+        labels.append(snippet.label());
+    }
+
+    if (!labels.isEmpty())
+    {
+        auto first = m_count == 0;
+        if (first)
+        {
+            m_snippets.clear();
+        }
+
+        for (auto &&snippet : snippets)
+        {
+            m_snippets.insert(snippet.label(), snippet);
+        }
+
+        m_count += static_cast<int>(labels.size());
+        emit completionsAdded(labels, first);
+    }
+
+    if (last)
+    {
+        m_running = false;
+        emit finished(m_count);
+    }
+}
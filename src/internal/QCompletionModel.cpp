@@ -0,0 +1,147 @@
+// QCodeEditor
+#include <internal/QCompletionModel.hpp>
+
+// Qt
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QStringView>
+#else
+#include <QStringRef>
+#endif
+
+#include <algorithm>
+
+QCompletionModel::QCompletionModel(const QStringList &words, Qt::CaseSensitivity sorting, QObject *parent)
+    : QAbstractListModel(parent), m_text(), m_offsets({0}), m_sorting(sorting)
+{
+    setWords(words);
+}
+
+void QCompletionModel::setWords(const QStringList &words)
+{
+    // Words, that only differ by case, are kept in a stable order
+    auto less = [this](const QString &a, const QString &b) {
+        auto result = a.compare(b, m_sorting);
+        return result != 0 ? result < 0 : a < b;
+    };
+
+    auto sorted = words;
+    std::sort(sorted.begin(), sorted.end(), less);
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    int length = 0;
+    for (auto &&word : sorted)
+    {
+        length += static_cast<int>(word.size());
+    }
+
+    beginResetModel();
+
+    m_text.clear();
+    m_text.reserve(length);
+    m_offsets.clear();
+    m_offsets.reserve(static_cast<int>(sorted.size()) + 1);
+    m_offsets.append(0);
+
+    for (auto &&word : sorted)
+    {
+        m_text.append(word);
+        m_offsets.append(static_cast<int>(m_text.size()));
+    }
+
+    endResetModel();
+}
+
+Qt::CaseSensitivity QCompletionModel::sorting() const
+{
+    return m_sorting;
+}
+
+QString QCompletionModel::word(int row) const
+{
+    return m_text.mid(m_offsets.at(row), m_offsets.at(row + 1) - m_offsets.at(row));
+}
+
+QPair<int, int> QCompletionModel::prefixRange(const QString &prefix) const
+{
+    auto compare = [this, &prefix](int row) { return comparePrefix(row, prefix); };
+
+    // Words, that start with the prefix, compare equal to it, when cut to its length
+    int first = 0;
+    int last = rowCount();
+    for (int count = last - first; count > 0;)
+    {
+        auto step = count / 2;
+        if (compare(first + step) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    int end = first;
+    for (int count = last - end; count > 0;)
+    {
+        auto step = count / 2;
+        if (compare(end + step) <= 0)
+        {
+            end += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return {first, end};
+}
+
+QStringList QCompletionModel::wordsWithPrefix(const QString &prefix, int limit) const
+{
+    auto range = prefixRange(prefix);
+    if (limit >= 0)
+    {
+        range.second = qMin(range.second, range.first + limit);
+    }
+
+    QStringList result;
+    result.reserve(range.second - range.first);
+    for (int row = range.first; row < range.second; ++row)
+    {
+        result.append(word(row));
+    }
+
+    return result;
+}
+
+int QCompletionModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_offsets.size()) - 1;
+}
+
+QVariant QCompletionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || (role != Qt::DisplayRole && role != Qt::EditRole))
+    {
+        return QVariant();
+    }
+
+    return word(index.row());
+}
+
+int QCompletionModel::comparePrefix(int row, const QString &prefix) const
+{
+    auto offset = m_offsets.at(row);
+    auto length = qMin(m_offsets.at(row + 1) - offset, static_cast<int>(prefix.size()));
+
+    // QStringView compares by case sensitivity from Qt 5.12 on, QStringRef is gone in Qt 6
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    return QStringView(m_text.constData() + offset, length).compare(QStringView(prefix), m_sorting);
+#else
+    return QStringRef(&m_text, offset, length).compare(prefix, m_sorting);
+#endif
+}
@@ -0,0 +1,206 @@
+// QCodeEditor
+#include <internal/QCompletionProvider.hpp>
+
+// Qt
+#include <QSet>
+
+#include <algorithm>
+
+// Completions are delivered to the popup in batches of this size
+static const int BATCH_SIZE = 256;
+
+// Document words gain up to this much score, each, for frequency and for proximity to the cursor
+static const int MAXIMUM_FREQUENCY_BONUS = 12;
+static const int MAXIMUM_PROXIMITY_BONUS = 12;
+
+// Number of bits of a value, so bonuses change by orders of magnitude
+static int bitLength(int value)
+{
+    int bits = 0;
+    for (; value > 0; value >>= 1)
+    {
+        ++bits;
+    }
+
+    return bits;
+}
+
+QCompletionProvider::Request::Request(std::function<bool()> cancelled,
+                                      std::function<void(const QStringList &)> deliver,
+                                      std::function<void(const QVector<QSnippet> &)> deliverSnippets)
+    : m_cancelled(std::move(cancelled)), m_deliver(std::move(deliver)), m_deliverSnippets(std::move(deliverSnippets))
+{
+}
+
+bool QCompletionProvider::Request::isCancelled() const
+{
+    return m_cancelled();
+}
+
+void QCompletionProvider::Request::addCompletions(const QStringList &completions) const
+{
+    if (!completions.isEmpty() && !isCancelled())
+    {
+        m_deliver(completions);
+    }
+}
+
+void QCompletionProvider::Request::addSnippets(const QVector<QSnippet> &snippets) const
+{
+    if (!snippets.isEmpty() && m_deliverSnippets && !isCancelled())
+    {
+        m_deliverSnippets(snippets);
+    }
+}
+
+QWordListCompletionProvider::QWordListCompletionProvider(const QStringList &words) : m_words(words)
+{
+    std::sort(m_words.begin(), m_words.end());
+    m_words.erase(std::unique(m_words.begin(), m_words.end()), m_words.end());
+}
+
+QStringList QWordListCompletionProvider::words() const
+{
+    return m_words;
+}
+
+void QWordListCompletionProvider::complete(const Context &context, const Request &request) const
+{
+    // Words with the prefix follow each other in the sorted list
+    auto it = std::lower_bound(m_words.cbegin(), m_words.cend(), context.prefix);
+
+    QStringList batch;
+    for (; it != m_words.cend() && it->startsWith(context.prefix); ++it)
+    {
+        batch.append(*it);
+
+        if (batch.size() == BATCH_SIZE)
+        {
+            if (request.isCancelled())
+            {
+                return;
+            }
+
+            request.addCompletions(batch);
+            batch.clear();
+        }
+    }
+
+    request.addCompletions(batch);
+}
+
+QFuzzyCompletionProvider::QFuzzyCompletionProvider(const QStringList &words, int limit)
+    : m_matcher(words), m_limit(limit)
+{
+}
+
+int QFuzzyCompletionProvider::limit() const
+{
+    return m_limit;
+}
+
+void QFuzzyCompletionProvider::complete(const Context &context, const Request &request) const
+{
+    // Ranking needs all candidates, so the completions come in one batch
+    auto matches = m_matcher.match(context.prefix, m_limit, [&request] { return request.isCancelled(); });
+
+    QStringList completions;
+    completions.reserve(static_cast<int>(matches.size()));
+    for (auto &&match : matches)
+    {
+        completions.append(m_matcher.candidate(match.index));
+    }
+
+    request.addCompletions(completions);
+}
+
+QDocumentWordCompletionProvider::QDocumentWordCompletionProvider(const QSharedPointer<QCompletionProvider> &provider,
+                                                                 int limit)
+    : m_provider(provider), m_limit(limit)
+{
+}
+
+QSharedPointer<QCompletionProvider> QDocumentWordCompletionProvider::provider() const
+{
+    return m_provider;
+}
+
+void QDocumentWordCompletionProvider::complete(const Context &context, const Request &request) const
+{
+    struct Ranked
+    {
+        QString word;
+        int score;
+    };
+
+    QStringList completions;
+    if (m_provider)
+    {
+        QCompletionProvider::Request providerRequest(
+            [&request] { return request.isCancelled(); },
+            [&completions](const QStringList &batch) { completions += batch; },
+            [&request](const QVector<QSnippet> &snippets) { request.addSnippets(snippets); });
+        m_provider->complete(context, providerRequest);
+    }
+
+    QStringList words;
+    words.reserve(static_cast<int>(context.documentWords.size()));
+    for (auto &&documentWord : context.documentWords)
+    {
+        words.append(documentWord.word);
+    }
+
+    if (request.isCancelled())
+    {
+        return;
+    }
+
+    // Both lists are scored alike, so they can be merged
+    QVector<Ranked> ranked;
+    QSet<QString> documentWords;
+    QFuzzyMatcher documentMatcher(words);
+    for (int i = 0; i < words.size(); ++i)
+    {
+        auto score = documentMatcher.score(context.prefix, i);
+        if (score < 0)
+        {
+            continue;
+        }
+
+        auto &documentWord = context.documentWords.at(i);
+        score += qMin(MAXIMUM_FREQUENCY_BONUS, 2 * (bitLength(documentWord.count) - 1));
+        score += qMax(0, MAXIMUM_PROXIMITY_BONUS - 2 * bitLength(documentWord.distance));
+
+        ranked.append({documentWord.word, score});
+        documentWords.insert(documentWord.word);
+    }
+
+    QFuzzyMatcher matcher(completions);
+    for (int i = 0; i < completions.size(); ++i)
+    {
+        auto score = matcher.score(context.prefix, i);
+        if (score >= 0 && !documentWords.contains(completions.at(i)))
+        {
+            ranked.append({completions.at(i), score});
+        }
+    }
+
+    auto count = qMin(m_limit, static_cast<int>(ranked.size()));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [](const Ranked &a, const Ranked &b) {
+        if (a.score != b.score)
+        {
+            return a.score > b.score;
+        }
+
+        return a.word.size() != b.word.size() ? a.word.size() < b.word.size() : a.word < b.word;
+    });
+
+    QStringList result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        result.append(ranked.at(i).word);
+    }
+
+    request.addCompletions(result);
+}
@@ -0,0 +1,289 @@
+// QCodeEditor
+#include <internal/QFuzzyMatcher.hpp>
+
+#include <algorithm>
+
+static const int SCORE_MATCH = 16;
+static const int SCORE_EXACT_CASE = 1;
+static const int BONUS_BOUNDARY = 8;
+static const int BONUS_CAMEL = 7;
+static const int BONUS_CONSECUTIVE = 4;
+static const int PENALTY_GAP_START = 3;
+static const int PENALTY_GAP_EXTENSION = 1;
+
+// Candidates between two checks for cancellation
+static const int CANCEL_CHECK_INTERVAL = 4096;
+
+// Folds character by character, so the folded text lines up with the original
+static QString foldCase(const QString &text)
+{
+    auto folded = text;
+    for (auto &character : folded)
+    {
+        character = character.toLower();
+    }
+
+    return folded;
+}
+
+QFuzzyMatcher::QFuzzyMatcher(const QStringList &candidates)
+    : m_candidates(candidates), m_text(), m_foldedText(), m_bonuses(), m_index()
+{
+    m_index.reserve(static_cast<int>(candidates.size()));
+
+    for (auto &&candidate : candidates)
+    {
+        Candidate entry{static_cast<int>(m_text.size()), static_cast<int>(candidate.size()), 0, 0};
+
+        for (int i = 0; i < candidate.size(); ++i)
+        {
+            auto character = candidate.at(i);
+            auto folded = character.toLower();
+
+            // Words start at the beginning and after separators, humps at upper case letters and digits
+            char bonus = 0;
+            if (i == 0 || (!candidate.at(i - 1).isLetterOrNumber() && character.isLetterOrNumber()))
+            {
+                bonus = BONUS_BOUNDARY;
+            }
+            else if ((candidate.at(i - 1).isLower() && character.isUpper()) ||
+                     (candidate.at(i - 1).isLetter() && character.isDigit()))
+            {
+                bonus = BONUS_CAMEL;
+            }
+
+            entry.mask |= maskOf(folded);
+            if (bonus != 0)
+            {
+                entry.bonusMask |= maskOf(folded);
+            }
+
+            m_text.append(character);
+            m_foldedText.append(folded);
+            m_bonuses.append(bonus);
+        }
+
+        m_index.append(entry);
+    }
+}
+
+int QFuzzyMatcher::count() const
+{
+    return static_cast<int>(m_index.size());
+}
+
+QString QFuzzyMatcher::candidate(int index) const
+{
+    return m_candidates.at(index);
+}
+
+QVector<QFuzzyMatcher::Match> QFuzzyMatcher::match(const QString &pattern, int limit,
+                                                   const std::function<bool()> &cancelled) const
+{
+    QVector<Match> result;
+    if (limit <= 0)
+    {
+        return result;
+    }
+
+    if (pattern.isEmpty())
+    {
+        for (int i = 0; i < qMin(limit, count()); ++i)
+        {
+            result.append({i, 0});
+        }
+
+        return result;
+    }
+
+    auto foldedPattern = foldCase(pattern);
+
+    quint64 patternMask = 0;
+    QVector<quint64> patternMasks;
+    patternMasks.reserve(static_cast<int>(foldedPattern.size()));
+    for (auto &&character : foldedPattern)
+    {
+        patternMasks.append(maskOf(character));
+        patternMask |= patternMasks.last();
+    }
+
+    // Better of two matches, the heap keeps the worst of the best ones on top
+    auto better = [this](const Match &a, const Match &b) {
+        if (a.score != b.score)
+        {
+            return a.score > b.score;
+        }
+
+        if (m_index.at(a.index).length != m_index.at(b.index).length)
+        {
+            return m_index.at(a.index).length < m_index.at(b.index).length;
+        }
+
+        return a.index < b.index;
+    };
+
+    for (int i = 0; i < m_index.size(); ++i)
+    {
+        if (cancelled && i % CANCEL_CHECK_INTERVAL == 0 && cancelled())
+        {
+            return QVector<Match>();
+        }
+
+        auto &candidate = m_index.at(i);
+        if ((candidate.mask & patternMask) != patternMask || candidate.length < foldedPattern.size())
+        {
+            continue;
+        }
+
+        // Once the heap is full, candidates, whose best score can't beat its worst match, aren't scored
+        if (result.size() == limit && !better({i, maximumScore(patternMasks, candidate)}, result.first()))
+        {
+            continue;
+        }
+
+        Match match{i, score(pattern, foldedPattern, candidate)};
+        if (match.score < 0)
+        {
+            continue;
+        }
+
+        if (result.size() < limit)
+        {
+            result.append(match);
+            std::push_heap(result.begin(), result.end(), better);
+        }
+        else if (better(match, result.first()))
+        {
+            std::pop_heap(result.begin(), result.end(), better);
+            result.last() = match;
+            std::push_heap(result.begin(), result.end(), better);
+        }
+    }
+
+    std::sort_heap(result.begin(), result.end(), better);
+    return result;
+}
+
+int QFuzzyMatcher::score(const QString &pattern, int index) const
+{
+    if (pattern.isEmpty())
+    {
+        return 0;
+    }
+
+    return score(pattern, foldCase(pattern), m_index.at(index));
+}
+
+int QFuzzyMatcher::maximumScore(const QVector<quint64> &patternMasks, const Candidate &candidate)
+{
+    auto patternLength = static_cast<int>(patternMasks.size());
+    auto result = patternLength * (SCORE_MATCH + SCORE_EXACT_CASE) + (patternLength - 1) * BONUS_CONSECUTIVE;
+
+    // Only characters, that occur at a word start or hump, may get a bonus
+    for (int p = 0; p < patternLength; ++p)
+    {
+        if ((candidate.bonusMask & patternMasks.at(p)) != 0)
+        {
+            result += BONUS_BOUNDARY * (p == 0 ? 2 : 1);
+        }
+    }
+
+    return result;
+}
+
+quint64 QFuzzyMatcher::maskOf(QChar character)
+{
+    auto code = character.unicode();
+
+    if (code >= 'a' && code <= 'z')
+    {
+        return quint64(1) << (code - 'a');
+    }
+
+    if (code >= '0' && code <= '9')
+    {
+        return quint64(1) << (26 + code - '0');
+    }
+
+    if (code == '_')
+    {
+        return quint64(1) << 36;
+    }
+
+    // Other characters share the remaining bits
+    return quint64(1) << (37 + code % 27);
+}
+
+int QFuzzyMatcher::score(const QString &pattern, const QString &foldedPattern, const Candidate &candidate) const
+{
+    auto text = m_text.constData() + candidate.offset;
+    auto folded = m_foldedText.constData() + candidate.offset;
+    auto bonuses = m_bonuses.constData() + candidate.offset;
+    auto patternLength = static_cast<int>(foldedPattern.size());
+
+    // The first occurrence of the whole subsequence ends the match
+    int end = -1;
+    for (int i = 0, p = 0; i < candidate.length; ++i)
+    {
+        if (folded[i] == foldedPattern.at(p) && ++p == patternLength)
+        {
+            end = i;
+            break;
+        }
+    }
+
+    if (end < 0)
+    {
+        return -1;
+    }
+
+    // Going back from there finds the shortest match, that ends there
+    int start = end;
+    for (int p = patternLength - 1; start >= 0; --start)
+    {
+        if (folded[start] == foldedPattern.at(p) && --p < 0)
+        {
+            break;
+        }
+    }
+
+    int result = 0;
+    bool consecutive = false;
+    bool inGap = false;
+
+    for (int i = start, p = 0; i <= end; ++i)
+    {
+        if (folded[i] != foldedPattern.at(p))
+        {
+            result -= inGap ? PENALTY_GAP_EXTENSION : PENALTY_GAP_START;
+            consecutive = false;
+            inGap = true;
+            continue;
+        }
+
+        // A word start, that the pattern starts with, counts twice
+        result += SCORE_MATCH + bonuses[i] * (p == 0 ? 2 : 1);
+
+        if (consecutive)
+        {
+            result += BONUS_CONSECUTIVE;
+        }
+
+        if (text[i] == pattern.at(p))
+        {
+            result += SCORE_EXACT_CASE;
+        }
+
+        consecutive = true;
+        inGap = false;
+        ++p;
+    }
+
+    // Leading characters, that were skipped, count as a gap
+    if (start > 0)
+    {
+        result -= PENALTY_GAP_START + qMin(start, 8) * PENALTY_GAP_EXTENSION;
+    }
+
+    return qMax(0, result);
+}
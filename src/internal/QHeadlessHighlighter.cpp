@@ -0,0 +1,287 @@
+// QCodeEditor
+#include <internal/QHeadlessHighlighter.hpp>
+#include <internal/QStyleSyntaxHighlighter.hpp>
+#include <internal/QSyntaxStyle.hpp>
+
+// Qt
+#include <QFile>
+#include <QFont>
+#include <QHash>
+#include <QTextCharFormat>
+#include <QtConcurrentMap>
+
+static QString htmlStyle(const QTextCharFormat &format)
+{
+    QString style;
+
+    if (format.hasProperty(QTextFormat::ForegroundBrush))
+    {
+        style += "color:" + format.foreground().color().name() + ";";
+    }
+
+    if (format.hasProperty(QTextFormat::BackgroundBrush))
+    {
+        style += "background-color:" + format.background().color().name() + ";";
+    }
+
+    if (format.hasProperty(QTextFormat::FontWeight) && format.fontWeight() > QFont::Normal)
+    {
+        style += "font-weight:bold;";
+    }
+
+    if (format.fontItalic())
+    {
+        style += "font-style:italic;";
+    }
+
+    if (format.fontUnderline())
+    {
+        style += "text-decoration:underline;";
+    }
+
+    return style;
+}
+
+static QString ansiSequence(const QTextCharFormat &format)
+{
+    QString sequence;
+
+    if (format.hasProperty(QTextFormat::ForegroundBrush))
+    {
+        auto color = format.foreground().color();
+        sequence += QString("\x1b[38;2;%1;%2;%3m").arg(color.red()).arg(color.green()).arg(color.blue());
+    }
+
+    if (format.hasProperty(QTextFormat::FontWeight) && format.fontWeight() > QFont::Normal)
+    {
+        sequence += "\x1b[1m";
+    }
+
+    if (format.fontItalic())
+    {
+        sequence += "\x1b[3m";
+    }
+
+    if (format.fontUnderline())
+    {
+        sequence += "\x1b[4m";
+    }
+
+    return sequence;
+}
+
+QHeadlessHighlighter::QHeadlessHighlighter(const QStyleSyntaxHighlighter *highlighter, const QSyntaxStyle *style)
+    : m_highlighter(highlighter), m_style(style)
+{
+}
+
+QVector<QVector<QHighlightToken>> QHeadlessHighlighter::tokenize(QStringView text) const
+{
+    return tokenizeLines(splitLines(text));
+}
+
+QString QHeadlessHighlighter::render(QStringView text, OutputFormat format) const
+{
+    auto lines = splitLines(text);
+    auto tokens = tokenizeLines(lines);
+
+    switch (format)
+    {
+    case OutputFormat::Html:
+        return renderHtml(lines, tokens);
+    case OutputFormat::Ansi:
+        return renderAnsi(lines, tokens);
+    }
+
+    return QString();
+}
+
+QString QHeadlessHighlighter::renderFile(const QString &path, OutputFormat format) const
+{
+    QFile fl(path);
+
+    if (!fl.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+
+    auto text = QString::fromUtf8(fl.readAll());
+
+    return render(text, format);
+}
+
+QStringList QHeadlessHighlighter::renderFiles(const QStringList &paths, OutputFormat format) const
+{
+    QVector<QString> results(paths.size());
+    auto resultData = results.data();
+
+    QVector<int> indices(paths.size());
+    for (int i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = i;
+    }
+
+    QtConcurrent::blockingMap(indices, [this, &paths, format, resultData](const int &index) {
+        resultData[index] = renderFile(paths.at(index), format);
+    });
+
+    QStringList list;
+    list.reserve(results.size());
+    for (auto &&result : results)
+    {
+        list.append(result);
+    }
+
+    return list;
+}
+
+QVector<QStringView> QHeadlessHighlighter::splitLines(QStringView text)
+{
+    QVector<QStringView> lines;
+    int lineStart = 0;
+
+    for (int i = 0; i <= text.size(); ++i)
+    {
+        if (i == text.size() || text[i] == QLatin1Char('\n'))
+        {
+            auto lineEnd = i;
+            if (lineEnd > lineStart && text[lineEnd - 1] == QLatin1Char('\r'))
+            {
+                --lineEnd;
+            }
+
+            lines.append(text.mid(lineStart, lineEnd - lineStart));
+            lineStart = i + 1;
+        }
+    }
+
+    return lines;
+}
+
+QVector<QVector<QHighlightToken>> QHeadlessHighlighter::tokenizeLines(const QVector<QStringView> &lines) const
+{
+    QVector<QVector<QHighlightToken>> result(lines.size());
+
+    if (m_highlighter == nullptr)
+    {
+        return result;
+    }
+
+    int state = -1;
+    QVector<QHighlightToken> tokens;
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        auto line = lines.at(i).toString();
+
+        tokens.clear();
+        state = m_highlighter->tokenizeBlock(line, state, tokens);
+        result[i] = QStyleSyntaxHighlighter::resolveTokens(tokens, line.length());
+    }
+
+    return result;
+}
+
+QString QHeadlessHighlighter::renderHtml(const QVector<QStringView> &lines,
+                                         const QVector<QVector<QHighlightToken>> &tokens) const
+{
+    QHash<QString, QString> styles;
+    QString html;
+
+    html += "<pre style=\"";
+    if (m_style)
+    {
+        html += htmlStyle(m_style->getFormat("Text"));
+    }
+    html += "\">";
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto &line = lines.at(i);
+        int position = 0;
+
+        for (auto &&token : tokens.at(i))
+        {
+            html += line.mid(position, token.start - position).toString().toHtmlEscaped();
+
+            auto style = styles.find(token.formatName);
+            if (style == styles.end())
+            {
+                style = styles.insert(token.formatName,
+                                      m_style ? htmlStyle(m_style->getFormat(token.formatName)) : QString());
+            }
+
+            auto text = line.mid(token.start, token.length).toString().toHtmlEscaped();
+            if (style->isEmpty())
+            {
+                html += text;
+            }
+            else
+            {
+                html += "<span style=\"" + *style + "\">" + text + "</span>";
+            }
+
+            position = token.start + token.length;
+        }
+
+        html += line.mid(position).toString().toHtmlEscaped();
+
+        if (i != lines.size() - 1)
+        {
+            html += '\n';
+        }
+    }
+
+    html += "</pre>";
+
+    return html;
+}
+
+QString QHeadlessHighlighter::renderAnsi(const QVector<QStringView> &lines,
+                                         const QVector<QVector<QHighlightToken>> &tokens) const
+{
+    static const QString RESET("\x1b[0m");
+
+    QHash<QString, QString> sequences;
+    QString result;
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto &line = lines.at(i);
+        int position = 0;
+
+        for (auto &&token : tokens.at(i))
+        {
+            result += line.mid(position, token.start - position).toString();
+
+            auto sequence = sequences.find(token.formatName);
+            if (sequence == sequences.end())
+            {
+                sequence = sequences.insert(token.formatName,
+                                            m_style ? ansiSequence(m_style->getFormat(token.formatName)) : QString());
+            }
+
+            if (sequence->isEmpty())
+            {
+                result += line.mid(token.start, token.length).toString();
+            }
+            else
+            {
+                result += *sequence;
+                result += line.mid(token.start, token.length).toString();
+                result += RESET;
+            }
+
+            position = token.start + token.length;
+        }
+
+        result += line.mid(position).toString();
+
+        if (i != lines.size() - 1)
+        {
+            result += '\n';
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,488 @@
+// QCodeEditor
+#include <internal/QFuzzyMatcher.hpp>
+#include <internal/QIdentifierIndex.hpp>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <algorithm>
+#include <climits>
+
+// Lines per chunk. A chunk is split at twice this size and merged with the next one at half of it.
+static const int CHUNK_SIZE = 256;
+
+QIdentifierIndex::QIdentifierIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_pattern(R"([_a-zA-Z][_a-zA-Z0-9]*)"), m_chunks(), m_lineCount(0),
+      m_identifiers()
+{
+    connect(m_document, &QTextDocument::contentsChange, this, &QIdentifierIndex::onContentsChange);
+    rebuild();
+}
+
+QIdentifierIndex::~QIdentifierIndex()
+{
+    clearLines();
+}
+
+void QIdentifierIndex::setIdentifierPattern(const QRegularExpression &pattern)
+{
+    m_pattern = pattern;
+    rebuild();
+}
+
+QRegularExpression QIdentifierIndex::identifierPattern() const
+{
+    return m_pattern;
+}
+
+QStringList QIdentifierIndex::identifiers() const
+{
+    return m_identifiers.keys();
+}
+
+int QIdentifierIndex::identifierCount() const
+{
+    return static_cast<int>(m_identifiers.size());
+}
+
+int QIdentifierIndex::occurrenceCount(const QString &identifier) const
+{
+    auto it = m_identifiers.constFind(identifier);
+    if (it == m_identifiers.cend())
+    {
+        return 0;
+    }
+
+    return static_cast<int>(it->postings.size());
+}
+
+QVector<QIdentifierIndex::Occurrence> QIdentifierIndex::occurrences(const QString &identifier) const
+{
+    return occurrencesInLines(identifier, 0, m_lineCount - 1);
+}
+
+QVector<QIdentifierIndex::Occurrence> QIdentifierIndex::occurrencesInLines(const QString &identifier, int firstLine,
+                                                                           int lastLine) const
+{
+    QVector<Occurrence> result;
+
+    auto it = m_identifiers.constFind(identifier);
+    if (it == m_identifiers.cend())
+    {
+        return result;
+    }
+
+    const auto &postings = it->postings;
+    auto first = std::lower_bound(postings.cbegin(), postings.cend(), firstLine,
+                                  [](const Posting &posting, int value) { return numberOf(posting.line) < value; });
+
+    for (auto posting = first; posting != postings.cend(); ++posting)
+    {
+        auto number = numberOf(posting->line);
+        if (number > lastLine)
+        {
+            break;
+        }
+
+        result.append({number, posting->column});
+    }
+
+    return result;
+}
+
+int QIdentifierIndex::distanceToNearestOccurrence(const QString &identifier, int line) const
+{
+    auto it = m_identifiers.constFind(identifier);
+    if (it == m_identifiers.cend())
+    {
+        return -1;
+    }
+
+    return distanceOf(it->postings, line);
+}
+
+QVector<QIdentifierIndex::Summary> QIdentifierIndex::identifiersMatching(const QString &pattern, int line) const
+{
+    quint64 patternMask = 0;
+    for (auto &&character : pattern)
+    {
+        patternMask |= QFuzzyMatcher::maskOf(character.toLower());
+    }
+
+    QVector<Summary> result;
+
+    // Identifiers, that lack a character of the pattern, are rejected by their mask alone
+    for (auto it = m_identifiers.cbegin(); it != m_identifiers.cend(); ++it)
+    {
+        if ((it->mask & patternMask) == patternMask)
+        {
+            result.append({it.key(), static_cast<int>(it->postings.size()), distanceOf(it->postings, line)});
+        }
+    }
+
+    return result;
+}
+
+qint64 QIdentifierIndex::memoryUsage() const
+{
+    qint64 bytes = sizeof(*this) + m_chunks.capacity() * sizeof(Chunk *);
+
+    // Identifier lists of the lines share their string data with the keys
+    for (auto &&chunk : m_chunks)
+    {
+        bytes += sizeof(Chunk) + chunk->lines.capacity() * sizeof(Line *);
+
+        for (auto &&line : chunk->lines)
+        {
+            bytes += sizeof(Line) + line->identifiers.size() * sizeof(QString);
+        }
+    }
+
+    for (auto it = m_identifiers.cbegin(); it != m_identifiers.cend(); ++it)
+    {
+        bytes += sizeof(QString) + it.key().size() * sizeof(QChar);
+        bytes += sizeof(Identifier) + it->postings.capacity() * sizeof(Posting);
+    }
+
+    return bytes;
+}
+
+void QIdentifierIndex::rebuild()
+{
+    clearLines();
+    m_identifiers.clear();
+
+    if (m_pattern.isValid() && !m_pattern.pattern().isEmpty())
+    {
+        m_chunks.reserve(m_document->blockCount() / CHUNK_SIZE + 1);
+
+        Chunk *chunk = nullptr;
+        for (auto block = m_document->begin(); block.isValid(); block = block.next())
+        {
+            if (chunk == nullptr || chunk->lines.size() == CHUNK_SIZE)
+            {
+                chunk = new Chunk{m_lineCount, QVector<Line *>()};
+                chunk->lines.reserve(CHUNK_SIZE);
+                m_chunks.append(chunk);
+            }
+
+            auto text = block.text();
+            auto line = new Line{chunk, static_cast<int>(chunk->lines.size()), qHash(text), QStringList()};
+            chunk->lines.append(line);
+            ++m_lineCount;
+            addPostings(line, text);
+        }
+    }
+
+    emit identifiersChanged();
+}
+
+void QIdentifierIndex::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    if (!m_pattern.isValid() || m_pattern.pattern().isEmpty())
+    {
+        return;
+    }
+
+    // Blocks outside of the changed range keep their text, only their number may shift
+    auto lastPosition = m_document->characterCount() - 1;
+    auto firstBlock = m_document->findBlock(qBound(0, position, lastPosition));
+    auto lastBlock = m_document->findBlock(qBound(0, position + charsAdded, lastPosition));
+    int firstLine = firstBlock.blockNumber();
+    int newCount = lastBlock.blockNumber() - firstLine + 1;
+    int delta = m_document->blockCount() - m_lineCount;
+    int oldCount = newCount - delta;
+
+    if (oldCount < 1 || firstLine + oldCount > m_lineCount)
+    {
+        rebuild();
+        return;
+    }
+
+    auto changed = false;
+
+    if (delta == 0)
+    {
+        // Most changes edit lines in place, or only reformat them while highlighting
+        auto block = firstBlock;
+        for (int i = firstLine; i < firstLine + newCount; ++i, block = block.next())
+        {
+            auto line = lineAt(i);
+            auto text = block.text();
+            auto hash = qHash(text);
+
+            if (hash == line->hash)
+            {
+                continue;
+            }
+
+            changed |= removePostings(line);
+            line->hash = hash;
+            changed |= addPostings(line, text);
+        }
+    }
+    else
+    {
+        changed = replaceLines(firstLine, oldCount, firstBlock, newCount);
+    }
+
+    if (changed)
+    {
+        emit identifiersChanged();
+    }
+}
+
+int QIdentifierIndex::distanceOf(const QVector<Posting> &postings, int line)
+{
+    if (postings.isEmpty())
+    {
+        return -1;
+    }
+
+    // The nearest occurrence is the first one at or after the line, or the one before it
+    auto next = std::lower_bound(postings.cbegin(), postings.cend(), line,
+                                 [](const Posting &posting, int value) { return numberOf(posting.line) < value; });
+
+    auto distance = INT_MAX;
+    if (next != postings.cend())
+    {
+        distance = numberOf(next->line) - line;
+    }
+
+    if (next != postings.cbegin())
+    {
+        distance = qMin(distance, line - numberOf((next - 1)->line));
+    }
+
+    return distance;
+}
+
+int QIdentifierIndex::numberOf(const Line *line)
+{
+    return line->chunk->first + line->index;
+}
+
+int QIdentifierIndex::chunkAt(int number) const
+{
+    auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), number,
+                               [](int value, const Chunk *chunk) { return value < chunk->first; });
+
+    return qMax(0, static_cast<int>(it - m_chunks.cbegin()) - 1);
+}
+
+QIdentifierIndex::Line *QIdentifierIndex::lineAt(int number) const
+{
+    auto chunk = m_chunks.at(chunkAt(number));
+    return chunk->lines.at(number - chunk->first);
+}
+
+bool QIdentifierIndex::replaceLines(int firstLine, int oldCount, QTextBlock block, int newCount)
+{
+    auto changed = false;
+
+    // Postings are removed while the line numbers still match their order
+    for (int i = firstLine; i < firstLine + oldCount; ++i)
+    {
+        changed |= removePostings(lineAt(i));
+    }
+
+    // The old lines may span several chunks, the ones they emptied are dropped
+    auto chunkIndex = chunkAt(firstLine);
+    auto chunk = m_chunks.at(chunkIndex);
+    auto index = firstLine - chunk->first;
+
+    // Chunks from the first one on, whose lines must be numbered again
+    int touched = 0;
+
+    auto remaining = oldCount;
+    auto current = chunkIndex;
+    auto start = index;
+    while (remaining > 0)
+    {
+        auto &lines = m_chunks.at(current)->lines;
+        auto count = qMin(remaining, static_cast<int>(lines.size()) - start);
+
+        for (int i = start; i < start + count; ++i)
+        {
+            delete lines.at(i);
+        }
+
+        lines.remove(start, count);
+        remaining -= count;
+        ++current;
+        ++touched;
+        start = 0;
+    }
+
+    for (int i = current - 1; i > chunkIndex; --i)
+    {
+        if (m_chunks.at(i)->lines.isEmpty())
+        {
+            delete m_chunks.at(i);
+            m_chunks.remove(i);
+            --touched;
+        }
+    }
+
+    // New lines take the place of the old ones in the first chunk
+    QStringList texts;
+    texts.reserve(newCount);
+
+    chunk->lines.insert(index, newCount, nullptr);
+    for (int i = index; i < index + newCount; ++i, block = block.next())
+    {
+        texts.append(block.text());
+        chunk->lines[i] = new Line{chunk, i, qHash(texts.last()), QStringList()};
+    }
+
+    m_lineCount += newCount - oldCount;
+
+    // Chunks are kept near their size, so neither the chunks nor their lines grow too many
+    if (chunk->lines.size() < CHUNK_SIZE / 2 && chunkIndex + 1 < m_chunks.size())
+    {
+        auto next = m_chunks.at(chunkIndex + 1);
+        chunk->lines += next->lines;
+        delete next;
+        m_chunks.remove(chunkIndex + 1);
+        touched = qMax(1, touched - 1);
+    }
+
+    while (chunk->lines.size() > 2 * CHUNK_SIZE)
+    {
+        auto split = new Chunk{0, chunk->lines.mid(chunk->lines.size() - CHUNK_SIZE)};
+        chunk->lines.resize(chunk->lines.size() - CHUNK_SIZE);
+        m_chunks.insert(chunkIndex + 1, split);
+        ++touched;
+    }
+
+    // Renumbering keeps the relative order, so postings stay sorted
+    renumber(chunkIndex, chunkIndex + touched - 1);
+
+    for (int i = firstLine; i < firstLine + newCount; ++i)
+    {
+        changed |= addPostings(lineAt(i), texts.at(i - firstLine));
+    }
+
+    return changed;
+}
+
+void QIdentifierIndex::renumber(int firstChunk, int lastChunk)
+{
+    for (int i = firstChunk; i <= lastChunk; ++i)
+    {
+        auto chunk = m_chunks.at(i);
+        for (int j = 0; j < chunk->lines.size(); ++j)
+        {
+            chunk->lines.at(j)->chunk = chunk;
+            chunk->lines.at(j)->index = j;
+        }
+    }
+
+    // Chunks after the renumbered ones only shift
+    int first = 0;
+    if (firstChunk > 0)
+    {
+        auto previous = m_chunks.at(firstChunk - 1);
+        first = previous->first + static_cast<int>(previous->lines.size());
+    }
+
+    for (int i = firstChunk; i < m_chunks.size(); ++i)
+    {
+        m_chunks.at(i)->first = first;
+        first += static_cast<int>(m_chunks.at(i)->lines.size());
+    }
+}
+
+void QIdentifierIndex::clearLines()
+{
+    for (auto &&chunk : m_chunks)
+    {
+        qDeleteAll(chunk->lines);
+    }
+
+    qDeleteAll(m_chunks);
+    m_chunks.clear();
+    m_lineCount = 0;
+}
+
+bool QIdentifierIndex::addPostings(Line *line, const QString &text)
+{
+    auto added = false;
+
+    auto matchIterator = m_pattern.globalMatch(text);
+    while (matchIterator.hasNext())
+    {
+        auto match = matchIterator.next();
+        if (match.capturedLength() == 0)
+        {
+            continue;
+        }
+
+        auto identifier = match.captured();
+        auto it = m_identifiers.find(identifier);
+        if (it == m_identifiers.end())
+        {
+            quint64 mask = 0;
+            for (auto &&character : identifier)
+            {
+                mask |= QFuzzyMatcher::maskOf(character.toLower());
+            }
+
+            it = m_identifiers.insert(identifier, {mask, QVector<Posting>()});
+            added = true;
+        }
+
+        if (!line->identifiers.contains(identifier))
+        {
+            line->identifiers.append(it.key());
+        }
+
+        Posting posting{line, static_cast<int>(match.capturedStart())};
+        auto &postings = it->postings;
+        auto position = std::lower_bound(postings.begin(), postings.end(), posting,
+                                         [](const Posting &lhs, const Posting &rhs) {
+                                             auto lhsNumber = numberOf(lhs.line);
+                                             auto rhsNumber = numberOf(rhs.line);
+                                             return lhsNumber < rhsNumber ||
+                                                    (lhsNumber == rhsNumber && lhs.column < rhs.column);
+                                         });
+        postings.insert(position, posting);
+    }
+
+    return added;
+}
+
+bool QIdentifierIndex::removePostings(Line *line)
+{
+    auto removed = false;
+
+    for (auto &&identifier : line->identifiers)
+    {
+        auto it = m_identifiers.find(identifier);
+        if (it == m_identifiers.end())
+        {
+            continue;
+        }
+
+        auto &postings = it->postings;
+        auto number = numberOf(line);
+        auto first = std::lower_bound(postings.begin(), postings.end(), number,
+                                      [](const Posting &posting, int value) { return numberOf(posting.line) < value; });
+        auto last = std::upper_bound(first, postings.end(), number,
+                                     [](int value, const Posting &posting) { return value < numberOf(posting.line); });
+        postings.erase(first, last);
+
+        if (postings.isEmpty())
+        {
+            m_identifiers.erase(it);
+            removed = true;
+        }
+    }
+
+    line->identifiers.clear();
+
+    return removed;
+}
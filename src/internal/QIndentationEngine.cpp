@@ -0,0 +1,366 @@
+// QCodeEditor
+#include <internal/QBracketIndex.hpp>
+#include <internal/QCodeBlockData.hpp>
+#include <internal/QIndentationEngine.hpp>
+
+// Qt
+#include <QRegularExpression>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QVector>
+
+#include <algorithm>
+
+// Lines further up aren't searched for the line to indent relative to
+static const int MAXIMUM_SCAN_LINES = 2000;
+
+int QIndentationEngine::indentation(const QTextBlock &block, int tabSize) const
+{
+    // Multi line comments and strings are formatted by hand
+    if (startsInsideToken(block))
+    {
+        return -1;
+    }
+
+    return nestedIndentation(block, -nesting(block).leadingCloses, tabSize);
+}
+
+bool QIndentationEngine::isIndentationSignificant() const
+{
+    return false;
+}
+
+bool QIndentationEngine::isElectric(const QString &text) const
+{
+    auto trimmed = text.trimmed();
+    return trimmed.length() == 1 && isClosingBracket(nullptr, trimmed.at(0));
+}
+
+int QIndentationEngine::indentationOf(const QString &text, int tabSize)
+{
+    tabSize = qMax(1, tabSize);
+
+    int column = 0;
+    for (auto &&character : text)
+    {
+        if (character == '\t')
+        {
+            column = (column / tabSize + 1) * tabSize;
+        }
+        else if (character.isSpace())
+        {
+            ++column;
+        }
+        else
+        {
+            return column;
+        }
+    }
+
+    return -1;
+}
+
+QIndentationEngine::LineNesting QIndentationEngine::nesting(const QTextBlock &block) const
+{
+    LineNesting result{0, 0};
+
+    auto text = block.text();
+    auto data = QCodeBlockData::get(block);
+
+    if (data != nullptr)
+    {
+        result.delta = data->bracketDelta;
+    }
+    else
+    {
+        for (auto &&character : text)
+        {
+            if (character == '(' || character == '[' || character == '{')
+            {
+                ++result.delta;
+            }
+            else if (isClosingBracket(nullptr, character))
+            {
+                --result.delta;
+            }
+        }
+    }
+
+    for (int i = 0; i < text.length(); ++i)
+    {
+        if (text.at(i).isSpace())
+        {
+            continue;
+        }
+
+        if (!isClosingBracket(data, text.at(i)) || !isCode(data, i))
+        {
+            break;
+        }
+
+        ++result.leadingCloses;
+    }
+
+    return result;
+}
+
+bool QIndentationEngine::isNestedByBrackets() const
+{
+    return true;
+}
+
+int QIndentationEngine::nestedIndentation(const QTextBlock &block, int level, int tabSize) const
+{
+    // Nesting at the end of the line, that is looked at, relative to the start of block and to level
+    int depth = -level;
+    int lines = 0;
+
+    auto index = isNestedByBrackets() ? QBracketIndex::get(block.document()) : nullptr;
+
+    for (auto previous = block.previous(); previous.isValid(); previous = previous.previous())
+    {
+        // Lines, whose nesting doesn't drop to level, are skipped by whole chunks
+        if (index != nullptr)
+        {
+            previous = index->findBackward(previous, QChar(), QChar(), depth);
+            if (!previous.isValid())
+            {
+                return 0;
+            }
+        }
+        else if (++lines > MAXIMUM_SCAN_LINES)
+        {
+            return -1;
+        }
+
+        auto lineNesting = nesting(previous);
+        depth -= lineNesting.delta;
+
+        auto indentation = indentationOf(previous.text(), tabSize);
+        if (indentation < 0 || startsInsideToken(previous))
+        {
+            continue;
+        }
+
+        // A line is indented by its nesting after its leading closing brackets
+        auto lineLevel = depth - lineNesting.leadingCloses;
+        if (lineLevel <= 0)
+        {
+            return indentation + (lineLevel < 0 ? qMax(1, tabSize) : 0);
+        }
+    }
+
+    return 0;
+}
+
+bool QIndentationEngine::startsInsideToken(const QTextBlock &block)
+{
+    // Rule based highlighters keep the open multi line rule in the state
+    auto previous = block.previous();
+    return previous.isValid() && previous.userState() > 0;
+}
+
+bool QIndentationEngine::isCode(const QCodeBlockData *data, int position)
+{
+    if (data == nullptr)
+    {
+        return true;
+    }
+
+    auto token = std::upper_bound(data->tokens.cbegin(), data->tokens.cend(), position,
+                                  [](int value, const QHighlightToken &token) { return value < token.start; });
+    if (token == data->tokens.cbegin())
+    {
+        return true;
+    }
+
+    --token;
+    return position >= token->start + token->length || token->code;
+}
+
+bool QIndentationEngine::isClosingBracket(const QCodeBlockData *data, QChar character)
+{
+    if (data == nullptr)
+    {
+        return character == ')' || character == ']' || character == '}';
+    }
+
+    return std::any_of(
+        data->bracketSummaries.cbegin(), data->bracketSummaries.cend(),
+        [character](const QCodeBlockData::BracketSummary &summary) { return summary.close == character; });
+}
+
+int QPythonIndentationEngine::indentation(const QTextBlock &block, int tabSize) const
+{
+    static QRegularExpression RE_BRANCH(R"(^\s*(?:elif|else|except|finally)\b)");
+    static QRegularExpression RE_LEAVE(R"(^\s*(?:return|pass|break|continue|raise)\b)");
+
+    if (startsInsideToken(block))
+    {
+        return -1;
+    }
+
+    // Lines inside brackets continue an expression, that isn't bound to the indentation
+    auto index = QBracketIndex::get(block.document());
+    if (index != nullptr && index->depth(block) > 0)
+    {
+        return QIndentationEngine::indentation(block, tabSize);
+    }
+
+    auto previous = block.previous();
+    while (previous.isValid() && indentationOf(previous.text(), tabSize) < 0)
+    {
+        previous = previous.previous();
+    }
+
+    if (!previous.isValid())
+    {
+        return 0;
+    }
+
+    // A statement, that spans several lines, is indented by its first one
+    auto statement = previous;
+    auto depth = index == nullptr ? 0 : index->depth(statement);
+    for (int lines = 0; lines < MAXIMUM_SCAN_LINES && statement.previous().isValid(); ++lines)
+    {
+        if (!startsInsideToken(statement) && depth <= 0)
+        {
+            break;
+        }
+
+        statement = statement.previous();
+
+        auto statementData = QCodeBlockData::get(statement);
+        if (statementData != nullptr)
+        {
+            depth -= statementData->bracketDelta;
+        }
+    }
+
+    auto text = previous.text();
+    auto previousData = QCodeBlockData::get(previous);
+    auto opensBlock = false;
+    for (int i = text.length() - 1; i >= 0; --i)
+    {
+        if (!text.at(i).isSpace() && isCode(previousData, i))
+        {
+            opensBlock = text.at(i) == ':';
+            break;
+        }
+    }
+
+    auto indentation = qMax(0, indentationOf(statement.text(), tabSize));
+    tabSize = qMax(1, tabSize);
+
+    if (RE_BRANCH.match(block.text()).hasMatch())
+    {
+        return opensBlock ? indentation : qMax(0, indentation - tabSize);
+    }
+
+    if (opensBlock)
+    {
+        return indentation + tabSize;
+    }
+
+    if (RE_LEAVE.match(statement.text()).hasMatch())
+    {
+        return qMax(0, indentation - tabSize);
+    }
+
+    return indentation;
+}
+
+bool QPythonIndentationEngine::isIndentationSignificant() const
+{
+    return true;
+}
+
+bool QPythonIndentationEngine::isElectric(const QString &text) const
+{
+    static QRegularExpression RE_BRANCH_COLON(R"(^\s*(?:(?:else|finally)\s*|(?:elif|except)\b.*):$)");
+
+    return QIndentationEngine::isElectric(text) || RE_BRANCH_COLON.match(text).hasMatch();
+}
+
+bool QLuaIndentationEngine::isElectric(const QString &text) const
+{
+    static QRegularExpression RE_CLOSING_WORD(R"(^\s*(?:end|else|elseif|until)$)");
+
+    return QIndentationEngine::isElectric(text) || RE_CLOSING_WORD.match(text).hasMatch();
+}
+
+QIndentationEngine::LineNesting QLuaIndentationEngine::nesting(const QTextBlock &block) const
+{
+    static QRegularExpression RE_BLOCK_WORD(R"(\b(?:function|do|then|repeat|else|elseif|end|until)\b)");
+
+    struct Word
+    {
+        int start;
+        int length;
+        int delta;
+        bool closes;
+    };
+
+    auto result = QIndentationEngine::nesting(block);
+    auto text = block.text();
+    auto data = QCodeBlockData::get(block);
+
+    QVector<Word> words;
+    auto matchIterator = RE_BLOCK_WORD.globalMatch(text);
+    while (matchIterator.hasNext())
+    {
+        auto match = matchIterator.next();
+        auto start = static_cast<int>(match.capturedStart());
+        if (!isCode(data, start))
+        {
+            continue;
+        }
+
+        // Else closes a block and opens one, elseif leaves the opening to its then
+        auto word = match.captured();
+        auto opens = word == "function" || word == "do" || word == "then" || word == "repeat" || word == "else";
+        auto closes = word == "end" || word == "until" || word == "else" || word == "elseif";
+        words.append({start, static_cast<int>(match.capturedLength()), (opens ? 1 : 0) - (closes ? 1 : 0), closes});
+        result.delta += words.last().delta;
+    }
+
+    // Closing words and brackets may follow each other, like end)
+    result.leadingCloses = 0;
+    auto word = words.cbegin();
+    for (int i = 0; i < text.length();)
+    {
+        if (text.at(i).isSpace())
+        {
+            ++i;
+            continue;
+        }
+
+        while (word != words.cend() && word->start < i)
+        {
+            ++word;
+        }
+
+        if (word != words.cend() && word->start == i && word->closes)
+        {
+            i += word->length;
+        }
+        else if (isClosingBracket(data, text.at(i)) && isCode(data, i))
+        {
+            ++i;
+        }
+        else
+        {
+            break;
+        }
+
+        ++result.leadingCloses;
+    }
+
+    return result;
+}
+
+bool QLuaIndentationEngine::isNestedByBrackets() const
+{
+    // Block words nest lines, that the bracket index doesn't know of
+    return false;
+}
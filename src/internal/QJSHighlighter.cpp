@@ -1,98 +1,6 @@
 // QCodeEditor
 #include <internal/QJSHighlighter.hpp>
-#include <internal/QLanguage.hpp>
-#include <internal/QSyntaxStyle.hpp>
 
-// Qt
-#include <QFile>
-
-QJSHighlighter::QJSHighlighter(QTextDocument *document)
-    : QStyleSyntaxHighlighter(document), m_highlightRules(), m_commentStartPattern(R"(/\*)"),
-      m_commentEndPattern(R"(\*/)")
-{
-    Q_INIT_RESOURCE(qcodeeditor_resources);
-    QFile fl(":/languages/js.xml");
-
-    if (!fl.open(QIODevice::ReadOnly))
-    {
-        return;
-    }
-
-    QLanguage language(&fl);
-
-    if (!language.isLoaded())
-    {
-        return;
-    }
-
-    auto keys = language.keys();
-    for (auto &&key : keys)
-    {
-        auto names = language.names(key);
-        for (auto &&name : names)
-        {
-            m_highlightRules.append({QRegularExpression(QString(R"(\b%1\b)").arg(name)), key});
-        }
-    }
-
-    // Numbers
-    m_highlightRules.append(
-        {QRegularExpression(
-             R"((?<=\b|\s|^)(?i)(?:(?:(?:(?:(?:\d+(?:'\d+)*)?\.(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)\.(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)?\.(?:[0-9a-f]+(?:'[0-9a-f]+)*)(?:p[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)\.?(?:p[+-]?(?:\d+(?:'\d+)*))))[lf]?)|(?:(?:(?:[1-9]\d*(?:'\d+)*)|(?:0[0-7]*(?:'[0-7]+)*)|(?:0x[0-9a-f]+(?:'[0-9a-f]+)*)|(?:0b[01]+(?:'[01]+)*))(?:u?l{0,2}|l{0,2}u?)))(?=\b|\s|$))"),
-         "Number"});
-
-    // Strings
-    m_highlightRules.append({QRegularExpression(R"("[^\n"]*")"), "String"});
-
-    // Single line
-    m_highlightRules.append({QRegularExpression(R"(//[^\n]*)"), "Comment"});
-
-    // Comment sequences for toggling support
-    m_commentLineSequence = "//";
-    m_startCommentBlockSequence = "/*";
-    m_endCommentBlockSequence = "*/";
-}
-
-void QJSHighlighter::highlightBlock(const QString &text)
+QJSHighlighter::QJSHighlighter(QTextDocument *document) : QRuleHighlighter(document)
 {
-    for (auto &rule : m_highlightRules)
-    {
-        auto matchIterator = rule.pattern.globalMatch(text);
-
-        while (matchIterator.hasNext())
-        {
-            auto match = matchIterator.next();
-
-            setFormat(match.capturedStart(), match.capturedLength(), syntaxStyle()->getFormat(rule.formatName));
-        }
-    }
-
-    setCurrentBlockState(0);
-
-    int startIndex = 0;
-    if (previousBlockState() != 1)
-    {
-        startIndex = text.indexOf(m_commentStartPattern);
-    }
-
-    while (startIndex >= 0)
-    {
-        auto match = m_commentEndPattern.match(text, startIndex);
-
-        int endIndex = match.capturedStart();
-        int commentLength = 0;
-
-        if (endIndex == -1)
-        {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
-        }
-        else
-        {
-            commentLength = endIndex - startIndex + match.capturedLength();
-        }
-
-        setFormat(startIndex, commentLength, syntaxStyle()->getFormat("Comment"));
-        startIndex = text.indexOf(m_commentStartPattern, startIndex + commentLength);
-    }
 }
@@ -0,0 +1,50 @@
+// QCodeEditor
+#include <internal/QCompletionModel.hpp>
+#include <internal/QCompletionProvider.hpp>
+#include <internal/QLanguage.hpp>
+#include <internal/QLanguageCompleter.hpp>
+
+// Qt
+#include <QFile>
+
+QLanguageCompleter::QLanguageCompleter(const QString &languageFile, QObject *parent)
+    : QCompleter(parent), m_completionProvider()
+{
+    QStringList list;
+
+    Q_INIT_RESOURCE(qcodeeditor_resources);
+    QFile fl(languageFile);
+
+    if (!fl.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QLanguage language(&fl);
+
+    if (!language.isLoaded())
+    {
+        return;
+    }
+
+    auto keys = language.keys();
+    for (auto &&key : keys)
+    {
+        auto names = language.names(key);
+        list.append(names);
+    }
+
+    m_completionProvider = QSharedPointer<QFuzzyCompletionProvider>::create(list);
+
+    // The order agrees with the case sensitivity, so QCompleter filters by binary search
+    setModel(new QCompletionModel(list, Qt::CaseSensitive, this));
+    setCompletionColumn(0);
+    setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    setCaseSensitivity(Qt::CaseSensitive);
+    setWrapAround(true);
+}
+
+QSharedPointer<QCompletionProvider> QLanguageCompleter::completionProvider() const
+{
+    return m_completionProvider;
+}
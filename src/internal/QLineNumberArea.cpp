@@ -5,6 +5,7 @@
 
 // Qt
 #include <QAbstractTextDocumentLayout>
+#include <QMouseEvent>
 #include <QPaintEvent>
 #include <QPainter>
 #include <QScrollBar>
@@ -32,7 +33,7 @@ void QLineNumberArea::updateEditorLineCount()
     space = 15 + m_codeEditParent->fontMetrics().width(QLatin1Char('9')) * digits;
 #endif
 
-    setFixedWidth(space);
+    setFixedWidth(space + foldMarkerWidth());
 }
 
 void QLineNumberArea::setSyntaxStyle(QSyntaxStyle *style)
@@ -121,13 +122,16 @@ void QLineNumberArea::paintEvent(QPaintEvent *event)
     currentLineFont.setItalic(currentLineFormat.fontItalic());
     painter.setFont(font);
 
-    auto lineWidth = width();
+    auto markerWidth = foldMarkerWidth();
+    auto lineWidth = width() - markerWidth;
     auto lineHeight = m_codeEditParent->fontMetrics().height();
     auto dirtyTop = dirtyRect.top();
     auto dirtyBottom = dirtyRect.bottom();
 
     while (block.isValid() && top <= dirtyBottom)
     {
+        auto lastFolded = block.isVisible() ? m_codeEditParent->lastFoldedLine(blockNumber) : -1;
+
         if (block.isVisible() && bottom >= dirtyTop)
         {
             auto number = QString::number(blockNumber + 1);
@@ -157,6 +161,12 @@ void QLineNumberArea::paintEvent(QPaintEvent *event)
                 painter.fillRect(0, top, 7, lineHeight, markerColor);
             }
 
+            auto folded = lastFolded >= 0;
+            if (folded || m_codeEditParent->isFoldable(blockNumber))
+            {
+                paintFoldMarker(painter, QRect(lineWidth, top, markerWidth, lineHeight), folded);
+            }
+
             auto isCurrentLine = m_codeEditParent->textCursor().blockNumber() == blockNumber;
             painter.setPen(isCurrentLine ? currentLine : otherLines);
 
@@ -172,9 +182,62 @@ void QLineNumberArea::paintEvent(QPaintEvent *event)
             }
         }
 
+        // Hidden lines of a fold take no space, painting goes on after the last one
+        if (lastFolded > blockNumber)
+        {
+            block = m_codeEditParent->document()->findBlockByNumber(lastFolded);
+            blockNumber = lastFolded;
+        }
+
         block = block.next();
         top = bottom;
         bottom = top + (int)m_codeEditParent->document()->documentLayout()->blockBoundingRect(block).height();
         ++blockNumber;
     }
 }
+
+void QLineNumberArea::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || event->pos().x() < width() - foldMarkerWidth())
+    {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    auto viewport = m_codeEditParent->viewport();
+    auto position = viewport->mapFrom(m_codeEditParent, mapTo(m_codeEditParent, event->pos()));
+    auto block = m_codeEditParent->cursorForPosition(QPoint(0, position.y())).block();
+
+    m_codeEditParent->toggleFold(block.blockNumber());
+}
+
+int QLineNumberArea::foldMarkerWidth() const
+{
+    return m_codeEditParent->fontMetrics().height();
+}
+
+void QLineNumberArea::paintFoldMarker(QPainter &painter, const QRect &rect, bool folded) const
+{
+    auto size = rect.height() / 4.0;
+    auto center = QRectF(rect).center();
+
+    // Folded lines point right, unfolded ones down
+    QPolygonF triangle;
+    if (folded)
+    {
+        triangle << center + QPointF(-size / 2, -size) << center + QPointF(-size / 2, size)
+                 << center + QPointF(size, 0);
+    }
+    else
+    {
+        triangle << center + QPointF(-size, -size / 2) << center + QPointF(size, -size / 2)
+                 << center + QPointF(0, size);
+    }
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(m_syntaxStyle->getFormat("LineNumber").foreground());
+    painter.drawPolygon(triangle);
+    painter.restore();
+}
@@ -0,0 +1,376 @@
+// QCodeEditor
+#include <internal/QSearchEngine.hpp>
+#include <internal/QUndoHistory.hpp>
+
+// Qt
+#include <QCoreApplication>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+static const int BATCH_SIZE = 4096;
+
+// Larger edits are scanned on the thread pool again instead of line by line
+static const int MAXIMUM_INCREMENTAL_LENGTH = 65536;
+
+QSearchEngine::QSearchEngine(QUndoHistory *history, QObject *parent)
+    : QObject(parent), m_history(history), m_document(history->document()), m_pattern(), m_matches(), m_scans(),
+      m_generation(0), m_scanEdits(), m_changedRanges(), m_searching(false), m_replacing(false)
+{
+    // Format changes, e.g. by highlighting, are reported by the document as edits of the same text
+    connect(m_history, &QUndoHistory::textReplaced, this, &QSearchEngine::onTextReplaced);
+}
+
+QSearchEngine::~QSearchEngine()
+{
+    // Cancelled scans may still run until their next match
+    ++m_generation;
+    for (auto &scan : m_scans)
+    {
+        scan.waitForFinished();
+    }
+}
+
+QRegularExpression QSearchEngine::plainTextPattern(const QString &text, bool caseSensitive, bool wholeWords)
+{
+    auto pattern = QRegularExpression::escape(text);
+    if (wholeWords)
+    {
+        pattern = R"(\b)" + pattern + R"(\b)";
+    }
+
+    return QRegularExpression(pattern, caseSensitive ? QRegularExpression::NoPatternOption
+                                                     : QRegularExpression::CaseInsensitiveOption);
+}
+
+void QSearchEngine::setPattern(const QRegularExpression &pattern)
+{
+    m_pattern = pattern;
+    startScan();
+}
+
+QRegularExpression QSearchEngine::pattern() const
+{
+    return m_pattern;
+}
+
+bool QSearchEngine::isSearching() const
+{
+    return m_searching;
+}
+
+int QSearchEngine::matchCount() const
+{
+    return m_matches.size();
+}
+
+QVector<QSearchEngine::Match> QSearchEngine::matches() const
+{
+    return m_matches;
+}
+
+QVector<QSearchEngine::Match> QSearchEngine::matchesInRange(int from, int to) const
+{
+    auto first = std::lower_bound(m_matches.cbegin(), m_matches.cend(), from, [](const Match &match, int value) {
+        return match.start + match.length <= value;
+    });
+
+    QVector<Match> result;
+    for (auto it = first; it != m_matches.cend() && it->start < to; ++it)
+    {
+        result.append(*it);
+    }
+
+    return result;
+}
+
+int QSearchEngine::matchIndexAt(int position) const
+{
+    auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), position, [](const Match &match, int value) {
+        return match.start + match.length <= value;
+    });
+
+    return static_cast<int>(it - m_matches.cbegin());
+}
+
+int QSearchEngine::replaceAll(const QString &replacement)
+{
+    if (m_searching)
+    {
+        // Deliver the batches, that are still queued
+        m_scans.last().waitForFinished();
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+
+    auto count = static_cast<int>(m_matches.size());
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Replace from the back, so earlier positions stay valid
+    m_replacing = true;
+    QTextCursor cursor(m_document);
+    cursor.beginEditBlock();
+    for (int i = count - 1; i >= 0; --i)
+    {
+        const auto &match = m_matches.at(i);
+        cursor.setPosition(match.start);
+        cursor.setPosition(match.start + match.length, QTextCursor::KeepAnchor);
+        cursor.insertText(replacement);
+        m_history->reportEdit(match.start, match.length, cursor.position() - match.start);
+    }
+    cursor.endEditBlock();
+    m_replacing = false;
+
+    // The replacements may match again
+    startScan();
+
+    return count;
+}
+
+void QSearchEngine::clear()
+{
+    m_pattern = QRegularExpression();
+    startScan();
+}
+
+void QSearchEngine::onTextReplaced(int position, int charsRemoved, int charsAdded)
+{
+    if (m_replacing || m_pattern.pattern().isEmpty() || !m_pattern.isValid())
+    {
+        return;
+    }
+
+    if (charsAdded > MAXIMUM_INCREMENTAL_LENGTH || charsRemoved > MAXIMUM_INCREMENTAL_LENGTH)
+    {
+        startScan();
+        return;
+    }
+
+    auto oldCount = m_matches.size();
+    auto delta = charsAdded - charsRemoved;
+
+    // Matches, that the edit touched, are dropped, the ones after it are moved
+    removeMatches(position, position + charsRemoved, delta);
+
+    if (m_searching)
+    {
+        // The running scan is kept, its batches are moved by the edits and the changed lines are rescanned at its end
+        for (auto &range : m_changedRanges)
+        {
+            if (range.second < position)
+            {
+                continue;
+            }
+
+            if (range.first > position + charsRemoved)
+            {
+                range.first += delta;
+                range.second += delta;
+            }
+            else
+            {
+                range.first = qMin(range.first, position);
+                range.second = qMax(range.second + delta, position + charsAdded);
+            }
+        }
+
+        m_scanEdits.append({position, charsRemoved, charsAdded});
+        m_changedRanges.append({position, position + charsAdded});
+    }
+    else
+    {
+        rescanLines(position, position + charsAdded);
+    }
+
+    if (m_matches.size() != oldCount)
+    {
+        emit matchCountChanged(m_matches.size());
+    }
+
+    emit matchesChanged();
+}
+
+int QSearchEngine::removeMatches(int from, int to, int delta)
+{
+    auto first = std::lower_bound(m_matches.begin(), m_matches.end(), from, [](const Match &match, int value) {
+        return match.start + match.length <= value;
+    });
+    auto last = std::lower_bound(first, m_matches.end(), to,
+                                 [](const Match &match, int value) { return match.start <= value; });
+
+    auto index = static_cast<int>(first - m_matches.begin());
+    m_matches.erase(first, last);
+
+    if (delta != 0)
+    {
+        for (int i = index; i < m_matches.size(); ++i)
+        {
+            m_matches[i].start += delta;
+        }
+    }
+
+    return index;
+}
+
+void QSearchEngine::rescanLines(int from, int to)
+{
+    // Matches don't span lines, so the whole lines, that contain the range, are scanned
+    auto lastPosition = m_document->characterCount() - 1;
+    auto firstBlock = m_document->findBlock(qBound(0, from, lastPosition));
+    auto lastBlock = m_document->findBlock(qBound(0, to, lastPosition));
+    from = firstBlock.position();
+    to = lastBlock.position() + lastBlock.length() - 1;
+
+    auto index = removeMatches(from, to, 0);
+
+    QTextCursor cursor(m_document);
+    cursor.setPosition(from);
+    cursor.setPosition(to, QTextCursor::KeepAnchor);
+    auto text = cursor.selectedText().replace(QChar::ParagraphSeparator, '\n');
+
+    QVector<Match> found;
+    auto matchIterator = m_pattern.globalMatch(text);
+    while (matchIterator.hasNext())
+    {
+        auto match = matchIterator.next();
+        if (match.capturedLength() > 0)
+        {
+            found.append({from + static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength())});
+        }
+    }
+
+    if (!found.isEmpty())
+    {
+        m_matches.insert(index, found.size(), Match());
+        std::copy(found.cbegin(), found.cend(), m_matches.begin() + index);
+    }
+}
+
+void QSearchEngine::startScan()
+{
+    cancelScan();
+    m_matches.clear();
+
+    if (m_pattern.pattern().isEmpty() || !m_pattern.isValid())
+    {
+        emit matchCountChanged(0);
+        emit matchesChanged();
+        return;
+    }
+
+    m_searching = true;
+
+    // The scan works on an immutable copy, the document may change meanwhile
+    int generation = ++m_generation;
+    auto snapshot = m_document->toPlainText();
+    auto pattern = m_pattern;
+
+    m_scans.erase(std::remove_if(m_scans.begin(), m_scans.end(),
+                                 [](const QFuture<void> &scan) { return scan.isFinished(); }),
+                  m_scans.end());
+
+    m_scans.append(QtConcurrent::run([this, generation, snapshot, pattern] {
+        QVector<Match> batch;
+        batch.reserve(BATCH_SIZE);
+
+        auto post = [this, generation](const QVector<Match> &matches, bool last) {
+            QMetaObject::invokeMethod(
+                this, [this, generation, matches, last] { appendMatches(generation, matches, last); },
+                Qt::QueuedConnection);
+        };
+
+        auto matchIterator = pattern.globalMatch(snapshot);
+        while (matchIterator.hasNext())
+        {
+            if (m_generation.load() != generation)
+            {
+                return;
+            }
+
+            auto match = matchIterator.next();
+            if (match.capturedLength() == 0)
+            {
+                continue;
+            }
+
+            batch.append({static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength())});
+            if (batch.size() == BATCH_SIZE)
+            {
+                post(batch, false);
+                batch.clear();
+            }
+        }
+
+        post(batch, true);
+    }));
+}
+
+void QSearchEngine::cancelScan()
+{
+    // The worker notices the new generation and its queued batches are ignored
+    ++m_generation;
+    m_searching = false;
+    m_scanEdits.clear();
+    m_changedRanges.clear();
+}
+
+void QSearchEngine::appendMatches(int generation, const QVector<Match> &batch, bool last)
+{
+    if (generation != m_generation.load())
+    {
+        return;
+    }
+
+    // The batch was found in the snapshot, the edits since move its matches, the ones, that they touched, are dropped
+    for (auto match : batch)
+    {
+        auto kept = true;
+        for (auto &&edit : m_scanEdits)
+        {
+            if (match.start + match.length <= edit.position)
+            {
+                continue;
+            }
+
+            if (match.start < edit.position + edit.charsRemoved)
+            {
+                kept = false;
+                break;
+            }
+
+            match.start += edit.charsAdded - edit.charsRemoved;
+        }
+
+        if (kept)
+        {
+            m_matches.append(match);
+        }
+    }
+
+    if (last)
+    {
+        m_searching = false;
+
+        // The lines, that were edited during the scan, are rescanned in the current text
+        for (auto &&range : m_changedRanges)
+        {
+            rescanLines(range.first, range.second);
+        }
+
+        m_scanEdits.clear();
+        m_changedRanges.clear();
+    }
+
+    emit matchCountChanged(m_matches.size());
+    emit matchesChanged();
+
+    if (last)
+    {
+        emit searchFinished();
+    }
+}
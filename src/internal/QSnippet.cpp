@@ -0,0 +1,261 @@
+// QCodeEditor
+#include <internal/QSnippet.hpp>
+
+// Collects the node, that defines the text of each tab stop number: the first one with a placeholder or choices
+template <class Node> static void collectPlaceholders(const QVector<Node> &nodes, QMap<int, const Node *> &placeholders)
+{
+    for (auto &&node : nodes)
+    {
+        if (node.number >= 0 && (node.hasPlaceholder || !node.choices.isEmpty()) &&
+            !placeholders.contains(node.number))
+        {
+            placeholders.insert(node.number, &node);
+        }
+
+        collectPlaceholders(node.children, placeholders);
+    }
+}
+
+QSnippet::QSnippet() : m_source(), m_label(), m_text(), m_fields()
+{
+}
+
+QSnippet::QSnippet(const QString &source, const QString &label)
+    : m_source(source), m_label(label), m_text(), m_fields()
+{
+    int position = 0;
+    auto nodes = parse(position, false);
+
+    QMap<int, const Node *> placeholders;
+    collectPlaceholders(nodes, placeholders);
+
+    QVector<int> expanding;
+    expand(nodes, placeholders, expanding, -1);
+}
+
+bool QSnippet::isEmpty() const
+{
+    return m_source.isEmpty();
+}
+
+QString QSnippet::label() const
+{
+    return m_label.isEmpty() ? m_text : m_label;
+}
+
+QString QSnippet::source() const
+{
+    return m_source;
+}
+
+QString QSnippet::text() const
+{
+    return m_text;
+}
+
+QVector<QSnippet::Field> QSnippet::fields() const
+{
+    return m_fields;
+}
+
+QSnippet QSnippet::indented(const QString &indentation) const
+{
+    auto result = *this;
+    if (indentation.isEmpty())
+    {
+        return result;
+    }
+
+    // Position of each character of the text in the indented text
+    QVector<int> positions;
+    positions.reserve(static_cast<int>(m_text.size()) + 1);
+    result.m_text.clear();
+
+    for (auto &&character : m_text)
+    {
+        positions.append(static_cast<int>(result.m_text.size()));
+        result.m_text.append(character);
+
+        if (character == '\n')
+        {
+            result.m_text.append(indentation);
+        }
+    }
+
+    positions.append(static_cast<int>(result.m_text.size()));
+
+    for (auto &field : result.m_fields)
+    {
+        auto end = positions.at(field.start + field.length);
+        field.start = positions.at(field.start);
+        field.length = end - field.start;
+    }
+
+    return result;
+}
+
+QVector<QSnippet::Node> QSnippet::parse(int &position, bool nested) const
+{
+    static const QString ESCAPED_CHARACTERS = R"($}\)";
+    static const QString ESCAPED_CHOICE_CHARACTERS = R"(,|\)";
+
+    QVector<Node> nodes;
+    QString text;
+    auto size = static_cast<int>(m_source.size());
+
+    auto appendNode = [&nodes, &text](const Node &node) {
+        if (!text.isEmpty())
+        {
+            Node textNode;
+            textNode.text = text;
+            nodes.append(textNode);
+            text.clear();
+        }
+
+        nodes.append(node);
+    };
+
+    while (position < size)
+    {
+        auto character = m_source.at(position);
+
+        if (character == '\\' && position + 1 < size && ESCAPED_CHARACTERS.contains(m_source.at(position + 1)))
+        {
+            text += m_source.at(position + 1);
+            position += 2;
+            continue;
+        }
+
+        if (nested && character == '}')
+        {
+            break;
+        }
+
+        if (character == '$')
+        {
+            auto braced = position + 1 < size && m_source.at(position + 1) == '{';
+            auto digits = position + (braced ? 2 : 1);
+            auto end = digits;
+            while (end < size && m_source.at(end).isDigit())
+            {
+                ++end;
+            }
+
+            Node node;
+            node.number = m_source.mid(digits, end - digits).toInt();
+
+            if (end > digits && !braced)
+            {
+                appendNode(node);
+                position = end;
+                continue;
+            }
+
+            if (end > digits && end < size && m_source.at(end) == '}')
+            {
+                appendNode(node);
+                position = end + 1;
+                continue;
+            }
+
+            if (end > digits && end < size && m_source.at(end) == ':')
+            {
+                auto inner = end + 1;
+                node.children = parse(inner, true);
+                node.hasPlaceholder = true;
+
+                if (inner < size)
+                {
+                    appendNode(node);
+                    position = inner + 1;
+                    continue;
+                }
+            }
+
+            if (end > digits && end < size && m_source.at(end) == '|')
+            {
+                QString choice;
+                auto inner = end + 1;
+                for (; inner < size; ++inner)
+                {
+                    auto choiceCharacter = m_source.at(inner);
+                    if (choiceCharacter == '\\' && inner + 1 < size &&
+                        ESCAPED_CHOICE_CHARACTERS.contains(m_source.at(inner + 1)))
+                    {
+                        choice += m_source.at(++inner);
+                    }
+                    else if (choiceCharacter == ',')
+                    {
+                        node.choices.append(choice);
+                        choice.clear();
+                    }
+                    else if (choiceCharacter == '|' && inner + 1 < size && m_source.at(inner + 1) == '}')
+                    {
+                        break;
+                    }
+                    else
+                    {
+                        choice += choiceCharacter;
+                    }
+                }
+
+                if (inner < size)
+                {
+                    node.choices.append(choice);
+                    appendNode(node);
+                    position = inner + 2;
+                    continue;
+                }
+            }
+        }
+
+        // Anything, that isn't a complete tab stop, is text
+        text += character;
+        ++position;
+    }
+
+    if (!text.isEmpty())
+    {
+        Node textNode;
+        textNode.text = text;
+        nodes.append(textNode);
+    }
+
+    return nodes;
+}
+
+void QSnippet::expand(const QVector<Node> &nodes, const QMap<int, const Node *> &placeholders,
+                      QVector<int> &expanding, int parent)
+{
+    for (auto &&node : nodes)
+    {
+        if (node.number < 0)
+        {
+            m_text += node.text;
+            continue;
+        }
+
+        // Linked tab stops show the text of the one, that defines it
+        auto placeholder = placeholders.value(node.number, &node);
+        auto index = static_cast<int>(m_fields.size());
+        m_fields.append({node.number, static_cast<int>(m_text.size()), 0, placeholder->choices, parent});
+
+        if (!expanding.contains(node.number))
+        {
+            expanding.append(node.number);
+
+            if (!placeholder->choices.isEmpty())
+            {
+                m_text += placeholder->choices.first();
+            }
+            else
+            {
+                expand(placeholder->children, placeholders, expanding, index);
+            }
+
+            expanding.removeLast();
+        }
+
+        m_fields[index].length = static_cast<int>(m_text.size()) - m_fields.at(index).start;
+    }
+}
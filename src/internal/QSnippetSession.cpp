@@ -0,0 +1,330 @@
+// QCodeEditor
+#include <internal/QSnippetSession.hpp>
+#include <internal/QUndoHistory.hpp>
+
+// Qt
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+
+QSnippetSession::QSnippetSession(QUndoHistory *history, QObject *parent)
+    : QObject(parent), m_history(history), m_document(history->document()), m_fields(), m_numbers(), m_current(0),
+      m_active(false), m_updatingLinkedFields(false), m_pendingLinkedField(-1)
+{
+    // Format changes, e.g. by highlighting, are reported by the document as edits of the same text
+    connect(m_history, &QUndoHistory::textReplaced, this, &QSnippetSession::onTextReplaced);
+}
+
+bool QSnippetSession::start(const QSnippet &snippet, int position)
+{
+    stop();
+
+    m_fields.clear();
+    m_numbers.clear();
+    m_fields.append({-1, position, position + static_cast<int>(snippet.text().size()), QStringList(), -1});
+
+    // Fields follow the whole snippet, so their indices are one higher than in the snippet
+    auto fields = snippet.fields();
+    for (auto &&field : fields)
+    {
+        auto start = position + field.start;
+        m_fields.append({field.number, start, start + field.length, field.choices, field.parent + 1});
+
+        if (field.number > 0 && !m_numbers.contains(field.number))
+        {
+            m_numbers.append(field.number);
+        }
+    }
+
+    // Tab stops are visited by number, the final one isn't visited
+    std::sort(m_numbers.begin(), m_numbers.end());
+
+    m_current = 0;
+    m_active = !m_numbers.isEmpty();
+    return m_active;
+}
+
+void QSnippetSession::stop()
+{
+    m_active = false;
+    m_pendingLinkedField = -1;
+}
+
+bool QSnippetSession::isActive() const
+{
+    return m_active;
+}
+
+bool QSnippetSession::next()
+{
+    if (!m_active || m_current + 1 >= m_numbers.size())
+    {
+        return false;
+    }
+
+    ++m_current;
+    return true;
+}
+
+bool QSnippetSession::previous()
+{
+    if (!m_active || m_current == 0)
+    {
+        return false;
+    }
+
+    --m_current;
+    return true;
+}
+
+QPair<int, int> QSnippetSession::currentRange() const
+{
+    if (m_active)
+    {
+        for (auto &&field : m_fields)
+        {
+            if (field.number == m_numbers.at(m_current))
+            {
+                return {field.start, field.end};
+            }
+        }
+    }
+
+    return {-1, -1};
+}
+
+QStringList QSnippetSession::currentChoices() const
+{
+    if (m_active)
+    {
+        for (auto &&field : m_fields)
+        {
+            if (field.number == m_numbers.at(m_current))
+            {
+                return field.choices;
+            }
+        }
+    }
+
+    return QStringList();
+}
+
+int QSnippetSession::finalPosition() const
+{
+    for (auto &&field : m_fields)
+    {
+        if (field.number == 0)
+        {
+            return field.start;
+        }
+    }
+
+    return m_fields.isEmpty() ? -1 : m_fields.first().end;
+}
+
+bool QSnippetSession::contains(int position) const
+{
+    return m_active && m_fields.first().start <= position && position <= m_fields.first().end;
+}
+
+bool QSnippetSession::replaceLinked(QTextCursor &cursor, const QString &text)
+{
+    if (!m_active)
+    {
+        return false;
+    }
+
+    auto position = cursor.selectionStart();
+    auto end = cursor.selectionEnd();
+    auto number = m_numbers.at(m_current);
+    auto linked = std::count_if(m_fields.cbegin(), m_fields.cend(),
+                                [number](const Field &field) { return field.number == number; });
+
+    auto grown = editedField(position, end);
+    if (grown < 0 || m_fields.at(grown).number != number || linked < 2)
+    {
+        return false;
+    }
+
+    // The edit block reports all fields as one change at its end, they're shifted here
+    m_updatingLinkedFields = true;
+    cursor.beginEditBlock();
+
+    cursor.insertText(text);
+    m_history->reportEdit(position, end - position, cursor.position() - position);
+    if (!shift(position, end - position, cursor.position() - position, grown) || !copyToLinkedFields(grown))
+    {
+        stop();
+    }
+
+    cursor.endEditBlock();
+    m_updatingLinkedFields = false;
+
+    return true;
+}
+
+void QSnippetSession::onTextReplaced(int position, int charsRemoved, int charsAdded)
+{
+    // Linked fields are shifted, while they're updated
+    if (!m_active || m_updatingLinkedFields)
+    {
+        return;
+    }
+
+    auto grown = editedField(position, position + charsRemoved);
+    if (!shift(position, charsRemoved, charsAdded, grown))
+    {
+        stop();
+        return;
+    }
+
+    auto number = grown < 0 ? -1 : m_fields.at(grown).number;
+    auto linked = std::count_if(m_fields.cbegin(), m_fields.cend(),
+                                [number](const Field &field) { return field.number == number; });
+    if (number <= 0 || linked < 2)
+    {
+        return;
+    }
+
+    // The document can't be changed, while it reports a change, so the linked fields follow right after
+    if (m_pendingLinkedField < 0)
+    {
+        QMetaObject::invokeMethod(
+            this,
+            [this] {
+                auto field = m_pendingLinkedField;
+                m_pendingLinkedField = -1;
+
+                if (m_active && field >= 0)
+                {
+                    updateLinkedFields(field);
+                }
+            },
+            Qt::QueuedConnection);
+    }
+
+    m_pendingLinkedField = grown;
+}
+
+int QSnippetSession::editedField(int position, int end) const
+{
+    auto number = m_numbers.at(m_current);
+    auto result = -1;
+
+    for (int i = 0; i < m_fields.size(); ++i)
+    {
+        auto &field = m_fields.at(i);
+
+        // Only the current tab stop and the whole snippet grow by typing at their bounds
+        auto inside = field.start < position && end < field.end;
+        auto atBounds = field.start <= position && end <= field.end;
+        if (!inside && !(atBounds && (field.number == number || field.number < 0)))
+        {
+            continue;
+        }
+
+        if (result < 0 || field.end - field.start <= m_fields.at(result).end - m_fields.at(result).start)
+        {
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+bool QSnippetSession::shift(int position, int charsRemoved, int charsAdded, int grown)
+{
+    auto end = position + charsRemoved;
+    auto delta = charsAdded - charsRemoved;
+
+    // The edited field and the ones around it grow
+    QVector<bool> growing(m_fields.size(), false);
+    for (auto i = grown; i >= 0; i = m_fields.at(i).parent)
+    {
+        growing[i] = true;
+    }
+
+    for (int i = 0; i < m_fields.size(); ++i)
+    {
+        auto &field = m_fields[i];
+
+        if (growing.at(i))
+        {
+            field.end += delta;
+        }
+        else if (field.end <= position)
+        {
+            continue;
+        }
+        else if (field.start >= end)
+        {
+            field.start += delta;
+            field.end += delta;
+        }
+        else if (position <= field.start && field.end <= end)
+        {
+            field.start = position;
+            field.end = position;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void QSnippetSession::updateLinkedFields(int field)
+{
+    // Linked fields change in the undo step of the typing
+    m_updatingLinkedFields = true;
+
+    QTextCursor cursor(m_document);
+    cursor.joinPreviousEditBlock();
+
+    if (!copyToLinkedFields(field))
+    {
+        stop();
+    }
+
+    cursor.endEditBlock();
+    m_updatingLinkedFields = false;
+}
+
+bool QSnippetSession::copyToLinkedFields(int field)
+{
+    auto source = m_fields.at(field);
+
+    QTextCursor cursor(m_document);
+    cursor.setPosition(source.start);
+    cursor.setPosition(source.end, QTextCursor::KeepAnchor);
+    auto text = cursor.selectedText().replace(QChar::ParagraphSeparator, '\n');
+
+    for (int i = 0; i < m_fields.size(); ++i)
+    {
+        if (i == field || m_fields.at(i).number != source.number)
+        {
+            continue;
+        }
+
+        auto start = m_fields.at(i).start;
+        auto end = m_fields.at(i).end;
+        cursor.setPosition(start);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        if (cursor.selectedText().replace(QChar::ParagraphSeparator, '\n') == text)
+        {
+            continue;
+        }
+
+        cursor.insertText(text);
+        m_history->reportEdit(start, end - start, cursor.position() - start);
+        if (!shift(start, end - start, cursor.position() - start, i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -1,9 +1,28 @@
 // QCodeEditor
+#include <internal/QBracketIndex.hpp>
+#include <internal/QCodeBlockData.hpp>
+#include <internal/QIndentationEngine.hpp>
 #include <internal/QStyleSyntaxHighlighter.hpp>
+#include <internal/QSyntaxStyle.hpp>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <limits>
+
+// Blocks per chunk below which splitting the document isn't worth the thread pool overhead
+static const int MINIMUM_CHUNK_SIZE = 256;
 
 QStyleSyntaxHighlighter::QStyleSyntaxHighlighter(QTextDocument *document)
-    : QSyntaxHighlighter(document), m_syntaxStyle(nullptr), m_commentLineSequence(), m_startCommentBlockSequence(),
-      m_endCommentBlockSequence()
+    : QSyntaxHighlighter(document), m_syntaxStyle(nullptr), m_precomputedBlocks(), m_semanticTokenLegend(),
+      m_semanticTokenData(), m_semanticTokens(), m_bracketPairs({{'(', ')'}, {'[', ']'}, {'{', '}'}}),
+      m_nonCodeFormats({"String", "Comment"}), m_foldingStyle(FoldingStyle::Brackets),
+      m_indentationEngine(QSharedPointer<QIndentationEngine>::create()), m_commentLineSequence(),
+      m_startCommentBlockSequence(), m_endCommentBlockSequence()
 {
 }
 
@@ -46,3 +65,457 @@ void QStyleSyntaxHighlighter::setEndCommentBlockSequence(const QString &endComme
 {
     m_endCommentBlockSequence = endCommentBlockSequence;
 }
+
+int QStyleSyntaxHighlighter::tokenizeBlock(const QString &text, int previousState,
+                                           QVector<QHighlightToken> &tokens) const
+{
+    Q_UNUSED(text)
+    Q_UNUSED(previousState)
+    Q_UNUSED(tokens)
+
+    return 0;
+}
+
+void QStyleSyntaxHighlighter::rehighlightParallel()
+{
+    auto doc = document();
+    if (doc == nullptr)
+    {
+        return;
+    }
+
+    const int threadCount = QThread::idealThreadCount();
+    const int blockCount = doc->blockCount();
+    if (threadCount <= 1 || blockCount < 2 * MINIMUM_CHUNK_SIZE)
+    {
+        rehighlight();
+        return;
+    }
+
+    // Snapshot the text on this thread, the document must not be touched by the workers
+    QVector<QString> texts;
+    QVector<int> oldStates;
+    texts.reserve(blockCount);
+    oldStates.reserve(blockCount);
+    for (auto block = doc->begin(); block.isValid(); block = block.next())
+    {
+        texts.append(block.text());
+        oldStates.append(block.userState());
+    }
+
+    struct Chunk
+    {
+        int begin;
+        int end;
+        int entryState;
+    };
+
+    // The entry state of a chunk is speculated from the previous highlighting
+    // if there was one, otherwise it's assumed to be outside of any multi line
+    // construct (state 0).
+    const int chunkSize = qMax(MINIMUM_CHUNK_SIZE, blockCount / (threadCount * 4) + 1);
+    QVector<Chunk> chunks;
+    for (int begin = 0; begin < blockCount; begin += chunkSize)
+    {
+        chunks.append({begin, qMin(begin + chunkSize, blockCount), begin == 0 ? -1 : qMax(0, oldStates[begin - 1])});
+    }
+
+    QVector<PrecomputedBlock> results(blockCount);
+    auto resultData = results.data();
+    auto textData = texts.constData();
+
+    auto tokenizeRange = [this, resultData, textData](int begin, int end, int state) {
+        for (int i = begin; i < end; ++i)
+        {
+            auto &result = resultData[i];
+            result.previousState = state;
+            result.length = textData[i].length();
+            result.tokens.clear();
+            result.state = tokenizeBlock(textData[i], state, result.tokens);
+            state = result.state;
+        }
+    };
+
+    QtConcurrent::blockingMap(chunks, [&tokenizeRange](const Chunk &chunk) {
+        tokenizeRange(chunk.begin, chunk.end, chunk.entryState);
+    });
+
+    // Reconcile: re-tokenize blocks whose entry state was mispredicted. Once a
+    // re-tokenized block ends in the state the speculative run expected, the
+    // rest of the chunk is already correct and is left untouched.
+    for (int i = 1; i < blockCount; ++i)
+    {
+        if (resultData[i].previousState != resultData[i - 1].state)
+        {
+            tokenizeRange(i, i + 1, resultData[i - 1].state);
+        }
+    }
+
+    m_precomputedBlocks = std::move(results);
+    rehighlight();
+    m_precomputedBlocks.clear();
+}
+
+QVector<QHighlightToken> QStyleSyntaxHighlighter::resolveTokens(const QVector<QHighlightToken> &tokens, int length)
+{
+    QVector<QHighlightToken> result;
+    if (tokens.isEmpty() || length <= 0)
+    {
+        return result;
+    }
+
+    // Paint token indices per character, later tokens override earlier ones
+    QVector<int> owner(length, -1);
+    for (int i = 0; i < tokens.size(); ++i)
+    {
+        const auto &token = tokens.at(i);
+        auto begin = qMax(0, token.start);
+        auto end = qMin(length, token.start + token.length);
+
+        for (int j = begin; j < end; ++j)
+        {
+            owner[j] = i;
+        }
+    }
+
+    for (int begin = 0; begin < length;)
+    {
+        auto end = begin + 1;
+        while (end < length && owner[end] == owner[begin])
+        {
+            ++end;
+        }
+
+        if (owner[begin] >= 0)
+        {
+            result.append({begin, end - begin, tokens.at(owner[begin]).formatName});
+        }
+
+        begin = end;
+    }
+
+    return result;
+}
+
+void QStyleSyntaxHighlighter::highlightBlock(const QString &text)
+{
+    auto blockNumber = -1;
+    QVector<QHighlightToken> tokens;
+    auto precomputed = false;
+
+    if (!m_precomputedBlocks.isEmpty() || !m_semanticTokens.isEmpty())
+    {
+        blockNumber = currentBlock().blockNumber();
+    }
+
+    if (blockNumber >= 0 && blockNumber < m_precomputedBlocks.size())
+    {
+        const auto &block = m_precomputedBlocks.at(blockNumber);
+
+        if (block.previousState == previousBlockState() && block.length == text.length())
+        {
+            tokens = block.tokens;
+            setCurrentBlockState(block.state);
+            precomputed = true;
+        }
+    }
+
+    if (!precomputed)
+    {
+        setCurrentBlockState(tokenizeBlock(text, previousBlockState(), tokens));
+    }
+
+    // Semantic tokens are merged on top of the lexical ones
+    if (blockNumber >= 0 && blockNumber < m_semanticTokens.size())
+    {
+        tokens.append(m_semanticTokens.at(blockNumber));
+    }
+
+    applyTokens(tokens);
+
+    // Keep the resolved token stream, so consumers don't have to lex the block again
+    auto data = QCodeBlockData::get(currentBlock());
+    if (data == nullptr && currentBlockUserData() == nullptr)
+    {
+        data = new QCodeBlockData;
+        setCurrentBlockUserData(data);
+    }
+
+    if (data != nullptr)
+    {
+        data->tokens = resolveTokens(tokens, text.length());
+        for (auto &&token : data->tokens)
+        {
+            token.code = !m_nonCodeFormats.contains(token.formatName);
+        }
+
+        auto summaries = data->bracketSummaries;
+        updateBrackets(data, text);
+
+        // Depths and searches over the nesting are resolved from the chunks, that didn't change
+        if (data->bracketSummaries != summaries)
+        {
+            auto index = QBracketIndex::get(document());
+            if (index == nullptr)
+            {
+                index = new QBracketIndex(document());
+            }
+
+            index->invalidate(currentBlock());
+        }
+    }
+}
+
+void QStyleSyntaxHighlighter::applyTokens(const QVector<QHighlightToken> &tokens)
+{
+    if (m_syntaxStyle == nullptr)
+    {
+        return;
+    }
+
+    for (auto &&token : tokens)
+    {
+        setFormat(token.start, token.length, m_syntaxStyle->getFormat(token.formatName));
+    }
+}
+
+void QStyleSyntaxHighlighter::setSemanticTokenLegend(const QStringList &formatNames)
+{
+    if (m_semanticTokenLegend == formatNames)
+    {
+        return;
+    }
+
+    m_semanticTokenLegend = formatNames;
+    updateSemanticTokens();
+}
+
+void QStyleSyntaxHighlighter::setSemanticTokens(const QVector<quint32> &data)
+{
+    m_semanticTokenData = data;
+    updateSemanticTokens();
+}
+
+void QStyleSyntaxHighlighter::setSemanticTokens(const QStringList &formatNames, const QVector<quint32> &data)
+{
+    m_semanticTokenLegend = formatNames;
+    m_semanticTokenData = data;
+    updateSemanticTokens();
+}
+
+void QStyleSyntaxHighlighter::applySemanticTokensEdits(const QVector<SemanticTokensEdit> &edits)
+{
+    auto sortedEdits = edits;
+    std::sort(sortedEdits.begin(), sortedEdits.end(),
+              [](const SemanticTokensEdit &lhs, const SemanticTokensEdit &rhs) { return lhs.start < rhs.start; });
+
+    // All edits refer to the old array, so the new one is assembled in a single pass
+    const int oldSize = m_semanticTokenData.size();
+    QVector<quint32> data;
+    data.reserve(oldSize);
+    int position = 0;
+
+    for (auto &&edit : sortedEdits)
+    {
+        auto start = qBound(position, edit.start, oldSize);
+
+        for (; position < start; ++position)
+        {
+            data.append(m_semanticTokenData[position]);
+        }
+
+        data.append(edit.data);
+        position = qMin(start + qMax(0, edit.deleteCount), oldSize);
+    }
+
+    for (; position < oldSize; ++position)
+    {
+        data.append(m_semanticTokenData[position]);
+    }
+
+    m_semanticTokenData = data;
+    updateSemanticTokens();
+}
+
+void QStyleSyntaxHighlighter::clearSemanticTokens()
+{
+    m_semanticTokenData.clear();
+    updateSemanticTokens();
+}
+
+void QStyleSyntaxHighlighter::setBracketPairs(const QVector<QPair<QChar, QChar>> &pairs)
+{
+    m_bracketPairs = pairs;
+}
+
+QVector<QPair<QChar, QChar>> QStyleSyntaxHighlighter::bracketPairs() const
+{
+    return m_bracketPairs;
+}
+
+void QStyleSyntaxHighlighter::setNonCodeFormats(const QStringList &formatNames)
+{
+    m_nonCodeFormats = formatNames;
+}
+
+QStringList QStyleSyntaxHighlighter::nonCodeFormats() const
+{
+    return m_nonCodeFormats;
+}
+
+void QStyleSyntaxHighlighter::setFoldingStyle(FoldingStyle style)
+{
+    m_foldingStyle = style;
+}
+
+QStyleSyntaxHighlighter::FoldingStyle QStyleSyntaxHighlighter::foldingStyle() const
+{
+    return m_foldingStyle;
+}
+
+void QStyleSyntaxHighlighter::setIndentationEngine(const QSharedPointer<QIndentationEngine> &engine)
+{
+    m_indentationEngine = engine;
+}
+
+QSharedPointer<QIndentationEngine> QStyleSyntaxHighlighter::indentationEngine() const
+{
+    return m_indentationEngine;
+}
+
+void QStyleSyntaxHighlighter::updateBrackets(QCodeBlockData *data, const QString &text) const
+{
+    data->brackets.clear();
+    data->bracketSummaries.clear();
+    data->bracketDelta = 0;
+
+    auto token = data->tokens.cbegin();
+    for (int i = 0; i < text.length(); ++i)
+    {
+        auto character = text.at(i);
+        auto isBracket = std::any_of(m_bracketPairs.cbegin(), m_bracketPairs.cend(), [character](const auto &pair) {
+            return pair.first == character || pair.second == character;
+        });
+
+        if (!isBracket)
+        {
+            continue;
+        }
+
+        // Tokens are sorted and don't overlap, so they're walked along with the text
+        while (token != data->tokens.cend() && token->start + token->length <= i)
+        {
+            ++token;
+        }
+
+        if (token != data->tokens.cend() && token->start <= i && !token->code)
+        {
+            continue;
+        }
+
+        data->brackets.append({i, character});
+    }
+
+    for (auto &&pair : m_bracketPairs)
+    {
+        int opens = 0;
+        int closes = 0;
+
+        for (auto &&bracket : data->brackets)
+        {
+            if (bracket.character == pair.first)
+            {
+                ++opens;
+            }
+            else if (bracket.character == pair.second)
+            {
+                if (opens > 0)
+                {
+                    --opens;
+                }
+                else
+                {
+                    ++closes;
+                }
+            }
+        }
+
+        data->bracketSummaries.append({pair.first, pair.second, opens, closes});
+        data->bracketDelta += opens - closes;
+    }
+}
+
+void QStyleSyntaxHighlighter::updateSemanticTokens()
+{
+    auto doc = document();
+    const qint64 blockCount = doc == nullptr ? 0 : doc->blockCount();
+    const qint64 maximum = std::numeric_limits<int>::max();
+
+    // The values are unsigned and summed up, they're narrowed to int only once they're known to fit
+    QVector<QVector<QHighlightToken>> lines;
+    qint64 line = 0;
+    qint64 character = 0;
+
+    for (int i = 0; i + 4 < m_semanticTokenData.size(); i += 5)
+    {
+        qint64 deltaLine = m_semanticTokenData[i];
+        qint64 deltaStart = m_semanticTokenData[i + 1];
+        qint64 length = m_semanticTokenData[i + 2];
+        qint64 tokenType = m_semanticTokenData[i + 3];
+
+        if (deltaLine != 0)
+        {
+            line += deltaLine;
+            character = deltaStart;
+        }
+        else
+        {
+            character += deltaStart;
+        }
+
+        // Lines only grow, so the tokens past the document all follow
+        if (line >= blockCount)
+        {
+            break;
+        }
+
+        if (tokenType >= m_semanticTokenLegend.size() || character + length > maximum)
+        {
+            continue;
+        }
+
+        if (lines.size() <= line)
+        {
+            lines.resize(static_cast<int>(line) + 1);
+        }
+
+        lines[static_cast<int>(line)].append({static_cast<int>(character), static_cast<int>(length),
+                                              m_semanticTokenLegend.at(static_cast<int>(tokenType))});
+    }
+
+    auto oldLines = m_semanticTokens;
+    m_semanticTokens = lines;
+
+    if (doc == nullptr)
+    {
+        return;
+    }
+
+    const QVector<QHighlightToken> empty;
+    const int lineCount = qMax(oldLines.size(), lines.size());
+
+    for (int i = 0; i < lineCount; ++i)
+    {
+        const auto &oldTokens = i < oldLines.size() ? oldLines.at(i) : empty;
+        const auto &newTokens = i < lines.size() ? lines.at(i) : empty;
+
+        if (oldTokens != newTokens)
+        {
+            auto block = doc->findBlockByNumber(i);
+            if (block.isValid())
+            {
+                rehighlightBlock(block);
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+// QCodeEditor
+#include <internal/QTaskScheduler.hpp>
+
+// Qt
+#include <QTimer>
+
+#include <climits>
+
+QTaskScheduler::QTaskScheduler(QObject *parent)
+    : QObject(parent), m_tasks(), m_runningCritical(false), m_deferredTimer(new QTimer(this)),
+      m_idleTimer(new QTimer(this)), m_idleInterval(100)
+{
+    m_deferredTimer->setSingleShot(true);
+    m_deferredTimer->setInterval(0);
+    connect(m_deferredTimer, &QTimer::timeout, this, [this] { run(Priority::Deferred, INT_MAX); });
+
+    m_idleTimer->setSingleShot(true);
+    connect(m_idleTimer, &QTimer::timeout, this, &QTaskScheduler::runIdle);
+}
+
+void QTaskScheduler::addTask(int task, Priority priority, std::function<void()> function)
+{
+    m_tasks.insert(task, {priority, std::move(function), false});
+}
+
+void QTaskScheduler::schedule(int task)
+{
+    auto it = m_tasks.find(task);
+    if (it == m_tasks.end())
+    {
+        return;
+    }
+
+    it->scheduled = true;
+
+    switch (it->priority)
+    {
+    case Priority::Critical:
+        runCritical();
+        break;
+    case Priority::Deferred:
+        if (!m_deferredTimer->isActive())
+        {
+            m_deferredTimer->start();
+        }
+        break;
+    case Priority::Idle:
+        m_idleTimer->start(m_idleInterval);
+        break;
+    }
+}
+
+void QTaskScheduler::cancel(int task)
+{
+    auto it = m_tasks.find(task);
+    if (it != m_tasks.end())
+    {
+        it->scheduled = false;
+    }
+}
+
+bool QTaskScheduler::isScheduled(int task) const
+{
+    auto it = m_tasks.constFind(task);
+    return it != m_tasks.cend() && it->scheduled;
+}
+
+void QTaskScheduler::postpone()
+{
+    // Idle tasks, that were already running one by one, wait for the whole interval again
+    if (m_idleTimer->isActive())
+    {
+        m_idleTimer->start(m_idleInterval);
+    }
+}
+
+void QTaskScheduler::flush()
+{
+    m_deferredTimer->stop();
+    m_idleTimer->stop();
+
+    run(Priority::Critical, INT_MAX);
+    run(Priority::Deferred, INT_MAX);
+    run(Priority::Idle, INT_MAX);
+}
+
+void QTaskScheduler::setIdleInterval(int msec)
+{
+    m_idleInterval = msec;
+}
+
+int QTaskScheduler::idleInterval() const
+{
+    return m_idleInterval;
+}
+
+bool QTaskScheduler::run(Priority priority, int limit)
+{
+    // Tasks may add or schedule tasks, so each one is looked up again
+    auto ids = m_tasks.keys();
+    for (auto &&id : ids)
+    {
+        auto it = m_tasks.find(id);
+        if (it == m_tasks.end() || it->priority != priority || !it->scheduled)
+        {
+            continue;
+        }
+
+        if (limit-- == 0)
+        {
+            return true;
+        }
+
+        it->scheduled = false;
+        auto function = it->function;
+        function();
+    }
+
+    return false;
+}
+
+void QTaskScheduler::runCritical()
+{
+    // Tasks, that a critical task schedules, run after it instead of within it
+    if (m_runningCritical)
+    {
+        return;
+    }
+
+    m_runningCritical = true;
+    while (hasScheduled(Priority::Critical))
+    {
+        run(Priority::Critical, INT_MAX);
+    }
+
+    m_runningCritical = false;
+}
+
+bool QTaskScheduler::hasScheduled(Priority priority) const
+{
+    for (auto &&task : m_tasks)
+    {
+        if (task.priority == priority && task.scheduled)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void QTaskScheduler::runIdle()
+{
+    // Input, that arrives between two idle tasks, postpones the rest
+    if (run(Priority::Idle, 1))
+    {
+        m_idleTimer->start(0);
+    }
+}
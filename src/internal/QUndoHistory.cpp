@@ -0,0 +1,583 @@
+// QCodeEditor
+#include <internal/QUndoHistory.hpp>
+
+// Qt
+#include <QDataStream>
+#include <QTextCursor>
+#include <QTextDocument>
+
+// The newest steps are typed into and undone most, they stay uncompressed
+static const int UNCOMPRESSED_STEPS = 32;
+
+// Smaller steps don't get smaller by compression
+static const int MINIMUM_COMPRESSED_SIZE = 256;
+
+// Characters per chunk of the copy of the text. A chunk is split at twice this size and merged below it.
+static const int TEXT_CHUNK_SIZE = 4096;
+
+static bool isWordCharacter(QChar character)
+{
+    return character.isLetterOrNumber() || character == '_';
+}
+
+QUndoHistory::QUndoHistory(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_enabled(false), m_text({QString()}), m_textLength(0), m_steps(),
+      m_index(0), m_cleanIndex(0), m_compacted(0), m_memoryLimit(32 * 1024 * 1024), m_memoryUsage(0),
+      m_stepOpen(false), m_closeGeneration(0), m_applying(false), m_editBlockReported(false),
+      m_undoAvailable(false), m_redoAvailable(false)
+{
+    readText();
+
+    connect(m_document, &QTextDocument::contentsChange, this, &QUndoHistory::onContentsChange);
+    connect(m_document, &QTextDocument::modificationChanged, this, [this](bool modified) {
+        if (!modified)
+        {
+            m_cleanIndex = m_index;
+        }
+    });
+}
+
+int QUndoHistory::undo()
+{
+    closeStep();
+
+    if (m_index == 0)
+    {
+        return -1;
+    }
+
+    auto position = apply(m_steps.at(--m_index), true);
+    m_document->setModified(m_index != m_cleanIndex);
+    updateAvailability();
+
+    return position;
+}
+
+int QUndoHistory::redo()
+{
+    closeStep();
+
+    if (m_index == m_steps.size())
+    {
+        return -1;
+    }
+
+    auto position = apply(m_steps.at(m_index++), false);
+    m_document->setModified(m_index != m_cleanIndex);
+    updateAvailability();
+
+    return position;
+}
+
+void QUndoHistory::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+
+    // The document would keep every removed text for its own undo stack
+    m_enabled = enabled;
+    m_document->setUndoRedoEnabled(!enabled);
+    clear();
+}
+
+bool QUndoHistory::isEnabled() const
+{
+    return m_enabled;
+}
+
+bool QUndoHistory::isUndoAvailable() const
+{
+    return m_index > 0;
+}
+
+bool QUndoHistory::isRedoAvailable() const
+{
+    return m_index < m_steps.size();
+}
+
+void QUndoHistory::closeStep()
+{
+    m_stepOpen = false;
+    ++m_closeGeneration;
+}
+
+void QUndoHistory::clear()
+{
+    closeStep();
+
+    m_steps.clear();
+    m_index = 0;
+    m_cleanIndex = m_document->isModified() ? -1 : 0;
+    m_compacted = 0;
+    m_memoryUsage = 0;
+
+    updateAvailability();
+}
+
+void QUndoHistory::setMemoryLimit(qint64 bytes)
+{
+    m_memoryLimit = bytes;
+    compact();
+    updateAvailability();
+}
+
+qint64 QUndoHistory::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+qint64 QUndoHistory::memoryUsage() const
+{
+    return m_memoryUsage + m_text.capacity() * sizeof(QString) + m_textLength * sizeof(QChar);
+}
+
+void QUndoHistory::reportEdit(int position, int charsRemoved, int charsAdded)
+{
+    // Outside of an edit block the document reported the edit already, the copy of the text is up to date then
+    if (replace(position, charsRemoved, charsAdded))
+    {
+        m_editBlockReported = true;
+    }
+}
+
+QTextDocument *QUndoHistory::document() const
+{
+    return m_document;
+}
+
+void QUndoHistory::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (!m_editBlockReported)
+    {
+        replace(position, charsRemoved, charsAdded);
+        return;
+    }
+
+    m_editBlockReported = false;
+
+    // An edit of the block, that wasn't reported, can't be told apart from the others, the history starts anew
+    if (m_textLength != m_document->characterCount() - 1)
+    {
+        readText();
+        clear();
+    }
+}
+
+bool QUndoHistory::replace(int position, int charsRemoved, int charsAdded)
+{
+    // The reported range may include the last paragraph separator, that isn't part of the text
+    QTextCursor cursor(m_document);
+    cursor.setPosition(position);
+    cursor.setPosition(qMax(position, qMin(position + charsAdded, m_document->characterCount() - 1)),
+                       QTextCursor::KeepAnchor);
+
+    Change change{position, textAt(position, charsRemoved), cursor.selectedText()};
+
+    // Format changes are reported as edits of the same text
+    if (change.removed == change.inserted)
+    {
+        return false;
+    }
+
+    replaceText(position, static_cast<int>(change.removed.size()), change.inserted);
+
+    // Only the text, that differs, is kept
+    auto removedLength = static_cast<int>(change.removed.size());
+    auto insertedLength = static_cast<int>(change.inserted.size());
+
+    int prefix = 0;
+    while (prefix < removedLength && prefix < insertedLength && change.removed.at(prefix) == change.inserted.at(prefix))
+    {
+        ++prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < removedLength - prefix && suffix < insertedLength - prefix &&
+           change.removed.at(removedLength - 1 - suffix) == change.inserted.at(insertedLength - 1 - suffix))
+    {
+        ++suffix;
+    }
+
+    change.position += prefix;
+    change.removed = change.removed.mid(prefix, removedLength - prefix - suffix);
+    change.inserted = change.inserted.mid(prefix, insertedLength - prefix - suffix);
+
+    emit textReplaced(change.position, static_cast<int>(change.removed.size()),
+                      static_cast<int>(change.inserted.size()));
+
+    if (m_enabled && !m_applying)
+    {
+        record(change);
+    }
+
+    return true;
+}
+
+void QUndoHistory::record(const Change &change)
+{
+    // A new edit drops the steps, that could be redone
+    if (m_index < m_steps.size())
+    {
+        for (int i = m_index; i < m_steps.size(); ++i)
+        {
+            account(m_steps.at(i), -1);
+        }
+
+        m_steps.resize(m_index);
+        m_compacted = qMin(m_compacted, m_index);
+
+        if (m_cleanIndex > m_index)
+        {
+            m_cleanIndex = -1;
+        }
+    }
+
+    if (m_stepOpen)
+    {
+        auto &step = m_steps[m_index - 1];
+        account(step, -1);
+        step.changes.append(change);
+        step.typing = false;
+        account(step, 1);
+        return;
+    }
+
+    auto typing = (change.removed.isEmpty() && change.inserted.size() == 1) ||
+                  (change.inserted.isEmpty() && change.removed.size() == 1);
+
+    if (typing && coalesce(change))
+    {
+        openStep();
+        return;
+    }
+
+    Step step{{change}, QByteArray(), typing};
+    account(step, 1);
+    m_steps.append(step);
+    ++m_index;
+
+    openStep();
+    compact();
+    updateAvailability();
+}
+
+void QUndoHistory::openStep()
+{
+    m_stepOpen = true;
+    auto generation = ++m_closeGeneration;
+
+    // Calls, that the handlers of this edit posted, come before the second hop
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation] {
+            QMetaObject::invokeMethod(
+                this,
+                [this, generation] {
+                    if (generation == m_closeGeneration)
+                    {
+                        m_stepOpen = false;
+                    }
+                },
+                Qt::QueuedConnection);
+        },
+        Qt::QueuedConnection);
+}
+
+bool QUndoHistory::coalesce(const Change &change)
+{
+    // A save ends the typing, so the saved state can be undone to
+    if (m_index == 0 || m_index != m_steps.size() || m_cleanIndex == m_index)
+    {
+        return false;
+    }
+
+    auto &step = m_steps[m_index - 1];
+    if (!step.typing || !step.compressed.isEmpty())
+    {
+        return false;
+    }
+
+    auto &last = step.changes.last();
+
+    // Typing continues after the last typed character, a word ends before whitespace or punctuation
+    if (last.removed.isEmpty() && change.removed.isEmpty() &&
+        change.position == last.position + last.inserted.size())
+    {
+        auto character = change.inserted.at(0);
+        auto previous = last.inserted.at(last.inserted.size() - 1);
+        if (character == QChar::ParagraphSeparator || previous == QChar::ParagraphSeparator ||
+            (!isWordCharacter(character) && isWordCharacter(previous)))
+        {
+            return false;
+        }
+
+        account(step, -1);
+        last.inserted += character;
+        account(step, 1);
+        return true;
+    }
+
+    // Backspace and Delete continue next to the last deleted character, while deleting the same kind
+    if (last.inserted.isEmpty() && change.inserted.isEmpty())
+    {
+        auto character = change.removed.at(0);
+        if (character == QChar::ParagraphSeparator ||
+            isWordCharacter(character) != isWordCharacter(last.removed.at(0)))
+        {
+            return false;
+        }
+
+        if (change.position + 1 == last.position)
+        {
+            account(step, -1);
+            last.removed.prepend(character);
+            last.position = change.position;
+            account(step, 1);
+            return true;
+        }
+
+        if (change.position == last.position)
+        {
+            account(step, -1);
+            last.removed += character;
+            account(step, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int QUndoHistory::apply(const Step &step, bool revert)
+{
+    auto stepChanges = changes(step);
+    auto count = static_cast<int>(stepChanges.size());
+    int position = -1;
+
+    // The changes of a step are one edit, they're reverted last to first and reported one by one
+    m_applying = true;
+
+    QTextCursor cursor(m_document);
+    cursor.beginEditBlock();
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto &change = stepChanges.at(revert ? count - 1 - i : i);
+        auto &from = revert ? change.inserted : change.removed;
+        auto &to = revert ? change.removed : change.inserted;
+
+        cursor.setPosition(change.position);
+        cursor.setPosition(change.position + static_cast<int>(from.size()), QTextCursor::KeepAnchor);
+        cursor.insertText(to);
+        position = change.position + static_cast<int>(to.size());
+
+        reportEdit(change.position, static_cast<int>(from.size()), position - change.position);
+    }
+
+    cursor.endEditBlock();
+
+    m_applying = false;
+
+    return position;
+}
+
+void QUndoHistory::compact()
+{
+    for (; m_compacted < m_steps.size() - UNCOMPRESSED_STEPS; ++m_compacted)
+    {
+        auto &step = m_steps[m_compacted];
+        account(step, -1);
+        compress(step);
+        account(step, 1);
+    }
+
+    // The last step is kept, even if it alone exceeds the limit
+    int dropped = 0;
+    while (m_memoryUsage > m_memoryLimit && dropped < m_index - 1)
+    {
+        account(m_steps.at(dropped++), -1);
+    }
+
+    if (dropped == 0)
+    {
+        return;
+    }
+
+    m_steps.remove(0, dropped);
+    m_index -= dropped;
+    m_compacted = qMax(0, m_compacted - dropped);
+
+    if (m_cleanIndex >= 0)
+    {
+        m_cleanIndex = m_cleanIndex < dropped ? -1 : m_cleanIndex - dropped;
+    }
+}
+
+void QUndoHistory::compress(Step &step)
+{
+    if (!step.compressed.isEmpty())
+    {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << static_cast<qint32>(step.changes.size());
+    for (auto &&change : step.changes)
+    {
+        stream << static_cast<qint32>(change.position) << change.removed << change.inserted;
+    }
+
+    if (data.size() < MINIMUM_COMPRESSED_SIZE)
+    {
+        return;
+    }
+
+    auto compressed = qCompress(data);
+    if (compressed.size() >= data.size())
+    {
+        return;
+    }
+
+    step.compressed = compressed;
+    step.changes.clear();
+    step.changes.squeeze();
+}
+
+QVector<QUndoHistory::Change> QUndoHistory::changes(const Step &step) const
+{
+    if (step.compressed.isEmpty())
+    {
+        return step.changes;
+    }
+
+    auto data = qUncompress(step.compressed);
+    QDataStream stream(data);
+
+    qint32 count = 0;
+    stream >> count;
+
+    QVector<Change> result;
+    result.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        qint32 position = 0;
+        Change change;
+        stream >> position >> change.removed >> change.inserted;
+        change.position = position;
+        result.append(change);
+    }
+
+    return result;
+}
+
+void QUndoHistory::readText()
+{
+    m_text = {QString()};
+    m_textLength = 0;
+
+    QTextCursor cursor(m_document);
+    cursor.select(QTextCursor::Document);
+    replaceText(0, 0, cursor.selectedText());
+}
+
+QString QUndoHistory::textAt(int position, int length) const
+{
+    QString result;
+
+    for (int i = 0; i < m_text.size() && length > 0; ++i)
+    {
+        auto size = static_cast<int>(m_text.at(i).size());
+        if (position >= size)
+        {
+            position -= size;
+            continue;
+        }
+
+        auto count = qMin(length, size - position);
+        result += m_text.at(i).mid(position, count);
+        length -= count;
+        position = 0;
+    }
+
+    return result;
+}
+
+void QUndoHistory::replaceText(int position, int length, const QString &text)
+{
+    m_textLength += static_cast<int>(text.size()) - length;
+
+    // The chunk, that the range starts in, takes the inserted text
+    int index = 0;
+    while (index + 1 < m_text.size() && position > m_text.at(index).size())
+    {
+        position -= static_cast<int>(m_text.at(index).size());
+        ++index;
+    }
+
+    auto removed = qMin(length, static_cast<int>(m_text.at(index).size()) - position);
+    m_text[index].remove(position, removed);
+    length -= removed;
+
+    // Chunks, that the range covers, are dropped, the one it ends in is cut
+    auto last = index + 1;
+    while (last < m_text.size() && length >= m_text.at(last).size())
+    {
+        length -= static_cast<int>(m_text.at(last).size());
+        ++last;
+    }
+
+    m_text.remove(index + 1, last - index - 1);
+    if (length > 0 && index + 1 < m_text.size())
+    {
+        m_text[index + 1].remove(0, length);
+    }
+
+    m_text[index].insert(position, text);
+
+    auto chunk = m_text.at(index);
+    auto size = static_cast<int>(chunk.size());
+    if (size > 2 * TEXT_CHUNK_SIZE)
+    {
+        auto count = (size + TEXT_CHUNK_SIZE - 1) / TEXT_CHUNK_SIZE;
+        m_text.insert(index + 1, count - 1, QString());
+        for (int i = 0; i < count; ++i)
+        {
+            m_text[index + i] = chunk.mid(i * TEXT_CHUNK_SIZE, TEXT_CHUNK_SIZE);
+        }
+    }
+    else if (index + 1 < m_text.size() && size + m_text.at(index + 1).size() <= TEXT_CHUNK_SIZE)
+    {
+        m_text[index] += m_text.at(index + 1);
+        m_text.remove(index + 1);
+    }
+}
+
+void QUndoHistory::account(const Step &step, int sign)
+{
+    qint64 bytes = sizeof(Step) + step.compressed.size();
+    for (auto &&change : step.changes)
+    {
+        bytes += sizeof(Change) + (change.removed.size() + change.inserted.size()) * sizeof(QChar);
+    }
+
+    m_memoryUsage += sign * bytes;
+}
+
+void QUndoHistory::updateAvailability()
+{
+    if (m_undoAvailable != isUndoAvailable())
+    {
+        m_undoAvailable = isUndoAvailable();
+        emit undoAvailable(m_undoAvailable);
+    }
+
+    if (m_redoAvailable != isRedoAvailable())
+    {
+        m_redoAvailable = isRedoAvailable();
+        emit redoAvailable(m_redoAvailable);
+    }
+}